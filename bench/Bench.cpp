@@ -0,0 +1,94 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+
+BenchRunner::BenchRunner(BenchOptions options)
+    : options(std::move(options)) {}
+
+bool BenchRunner::Matches(const std::string& name) const
+{
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+static double Percentile(const std::vector<double>& sorted, const double p)
+{
+    const auto rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+void BenchRunner::Run(const std::string& name, const std::size_t size, const std::size_t iterations,
+                      const std::function<void()>& setup,
+                      const std::function<void(std::size_t)>& body)
+{
+    if (!Matches(name))
+    {
+        return;
+    }
+
+    std::vector<double> samples;
+    samples.reserve(options.repetitions);
+
+    for (int r = 0; r < options.warmup + options.repetitions; ++r)
+    {
+        if (setup) setup();
+
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            body(i);
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        if (r >= options.warmup)
+        {
+            samples.push_back(std::chrono::duration<double, std::nano>(end - start).count() /
+                              static_cast<double>(iterations));
+        }
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    double sum = 0.0;
+    for (const double s : samples) sum += s;
+
+    BenchResult result{
+        name, size, iterations, options.repetitions,
+        Percentile(samples, 0.5), Percentile(samples, 0.99),
+        samples.front(), sum / static_cast<double>(samples.size())
+    };
+
+    std::printf("%-36s %8zu  median %12.1f ns  p99 %12.1f ns  min %12.1f ns\n",
+        result.name.c_str(), result.size, result.medianNs, result.p99Ns, result.minNs);
+    std::fflush(stdout);
+
+    results.push_back(std::move(result));
+}
+
+bool BenchRunner::WriteJson(const std::string& path, const std::string& simdLevel) const
+{
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file)
+    {
+        return false;
+    }
+
+    std::fprintf(file, "{\n  \"simd\": \"%s\",\n  \"warmup\": %d,\n  \"repetitions\": %d,\n  \"benchmarks\": [\n",
+        simdLevel.c_str(), options.warmup, options.repetitions);
+
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult& r = results[i];
+        std::fprintf(file,
+            "    {\"name\": \"%s\", \"size\": %zu, \"iterations\": %zu, "
+            "\"median_ns\": %.2f, \"p99_ns\": %.2f, \"min_ns\": %.2f, \"mean_ns\": %.2f}%s\n",
+            r.name.c_str(), r.size, r.iterations, r.medianNs, r.p99Ns, r.minNs, r.meanNs,
+            i + 1 < results.size() ? "," : "");
+    }
+
+    std::fprintf(file, "  ]\n}\n");
+    return std::fclose(file) == 0;
+}
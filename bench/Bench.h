@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct BenchOptions
+{
+    int warmup = 3;
+    int repetitions = 21;
+    std::string filter;
+    std::string jsonPath;
+};
+
+// Timings are per call of the benchmark body, in nanoseconds.
+struct BenchResult
+{
+    std::string name;
+    std::size_t size;
+    std::size_t iterations;
+    int repetitions;
+    double medianNs;
+    double p99Ns;
+    double minNs;
+    double meanNs;
+};
+
+// Runs each benchmark `warmup` + `repetitions` times. A repetition calls the
+// untimed `setup` once, then times `iterations` calls of `body(i)`; the
+// per-call average of each repetition is one sample.
+class BenchRunner
+{
+public:
+    explicit BenchRunner(BenchOptions options);
+
+    void Run(const std::string& name, std::size_t size, std::size_t iterations,
+             const std::function<void()>& setup,
+             const std::function<void(std::size_t)>& body);
+
+    [[nodiscard]] bool Matches(const std::string& name) const;
+    [[nodiscard]] const std::vector<BenchResult>& Results() const { return results; }
+
+    bool WriteJson(const std::string& path, const std::string& simdLevel) const;
+
+private:
+    BenchOptions options;
+    std::vector<BenchResult> results;
+};
+
+inline volatile float benchSink;
+
+// Keeps the optimizer from discarding a value the benchmark computes.
+inline void DoNotOptimize(const float value)
+{
+    benchSink = value;
+}
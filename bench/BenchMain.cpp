@@ -0,0 +1,324 @@
+#include "Bench.h"
+#include "Scenarios.h"
+
+#include "World.h"
+#include "Input.h"
+#include "ParticleKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+static constexpr float TICK = 1.0f / 60.0f;
+
+static const std::size_t LEVEL_SIZES[] = { 100, 1000, 10000 };
+static const std::size_t ACTOR_COUNTS[] = { 16, 64, 256 };
+
+struct Ray
+{
+    Vector2 origin;
+    Vector2 dir;
+    float maxDist;
+};
+
+static std::vector<Ray> MakeRays(const EnvIndex& env, const Rectangle& bounds, const std::size_t count)
+{
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> angle(0.0f, 6.28318530718f);
+    std::uniform_real_distribution<float> dist(200.0f, 1200.0f);
+
+    std::vector<Ray> rays(count);
+    for (auto& ray : rays)
+    {
+        const float a = angle(rng);
+        ray = { FindFreeSpot(env, bounds, rng), { cosf(a), sinf(a) }, dist(rng) };
+    }
+    return rays;
+}
+
+static void BenchEnvIndex(BenchRunner& runner)
+{
+    constexpr std::size_t RAYS = 4096;
+
+    for (const std::size_t size : LEVEL_SIZES)
+    {
+        const std::vector<EnvItem> level = MakeLevel(size);
+        const Rectangle bounds = LevelBounds(level);
+
+        for (const auto mode : { EnvIndex::Mode::Grid, EnvIndex::Mode::BVH })
+        {
+            const std::string suffix = mode == EnvIndex::Mode::Grid ? "/grid" : "/bvh";
+            if (!runner.Matches("envindex/cast_ray" + suffix) && !runner.Matches("envindex/query_rect" + suffix))
+            {
+                continue;
+            }
+
+            EnvIndex env;
+            env.Build(level, mode);
+            const std::vector<Ray> rays = MakeRays(env, bounds, RAYS);
+
+            runner.Run("envindex/cast_ray" + suffix, size, RAYS, nullptr, [&](const std::size_t i) {
+                const Ray& ray = rays[i];
+                DoNotOptimize(env.CastRay(ray.origin, ray.dir, ray.maxDist));
+            });
+
+            std::vector<int> out;
+            runner.Run("envindex/query_rect" + suffix, size, RAYS, nullptr, [&](const std::size_t i) {
+                const Vector2 p = rays[i].origin;
+                env.QueryRect({ p.x - 14.0f, p.y - 64.0f, 28.0f, 68.0f }, out);
+                DoNotOptimize(static_cast<float>(out.size()));
+            });
+        }
+    }
+}
+
+static void BenchBots(BenchRunner& runner)
+{
+    for (const std::size_t size : LEVEL_SIZES)
+    {
+        if (!runner.Matches("bot/line_of_sight")) break;
+
+        World world(16);
+        PopulateWorld(world, size, 64, 0);
+
+        std::mt19937 rng(5);
+        const Rectangle bounds = LevelBounds(world.EnvItems());
+        std::vector<Vector2> targets(4096);
+        for (auto& t : targets) t = FindFreeSpot(world.Env(), bounds, rng);
+
+        const std::vector<Bot>& bots = world.Bots();
+        runner.Run("bot/line_of_sight", size, targets.size(), nullptr, [&](const std::size_t i) {
+            DoNotOptimize(bots[i % bots.size()].HasLineOfSight(targets[i], world.Env()) ? 1.0f : 0.0f);
+        });
+    }
+
+    for (const std::size_t count : ACTOR_COUNTS)
+    {
+        if (!runner.Matches("bot/update")) break;
+
+        std::unique_ptr<World> world;
+        Vector2 target{};
+        runner.Run("bot/update", count, 60,
+            [&] {
+                world = std::make_unique<World>();
+                PopulateWorld(*world, 1000, count, 1);
+                target = world->Players().front().position;
+            },
+            [&](std::size_t) {
+                for (auto& bot : world->Bots())
+                {
+                    bot.Update(TICK, world->Env(), target, world->Projectiles());
+                }
+            });
+    }
+}
+
+static void BenchParticles(BenchRunner& runner)
+{
+    for (const std::size_t count : { std::size_t{ 1000 }, std::size_t{ 10000 }, std::size_t{ 50000 } })
+    {
+        for (const SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 })
+        {
+            const std::string name = std::string("particles/integrate/") + SimdLevelName(level);
+            if (level > DetectSimdLevel() || !runner.Matches(name)) continue;
+
+            std::vector<float> posX(count), posY(count), velX(count), velY(count), life(count);
+            std::vector<std::uint8_t> dead(count);
+            const ParticleSpan span{ posX.data(), posY.data(), velX.data(), velY.data(), life.data(), dead.data(), count };
+            const ParticleIntegrateFn fn = SelectParticleKernel(level);
+
+            runner.Run(name, count, 100,
+                [&] {
+                    std::mt19937 rng(1234);
+                    std::uniform_real_distribution<float> pos(0.0f, 2000.0f);
+                    std::uniform_real_distribution<float> vel(-240.0f, 240.0f);
+                    std::uniform_real_distribution<float> lifeDist(0.18f, 0.9f);
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        posX[i] = pos(rng); posY[i] = pos(rng);
+                        velX[i] = vel(rng); velY[i] = vel(rng);
+                        life[i] = lifeDist(rng);
+                    }
+                },
+                [&](std::size_t) { fn(span, TICK); });
+        }
+
+        if (!runner.Matches("particles/update")) continue;
+
+        ParticleSystem particles(count);
+        runner.Run("particles/update", count, 10,
+            [&] { FillParticles(particles, count); },
+            [&](std::size_t) { particles.Update(TICK); });
+    }
+}
+
+static void BenchProjectiles(BenchRunner& runner)
+{
+    for (const std::size_t count : { std::size_t{ 256 }, std::size_t{ 1024 }, std::size_t{ 4096 } })
+    {
+        if (!runner.Matches("projectiles/update")) break;
+
+        World world(16);
+        PopulateWorld(world, 1000, 64, 0);
+        const Rectangle bounds = LevelBounds(world.EnvItems());
+
+        std::vector<HitTarget> targets;
+        for (const auto& bot : world.Bots())
+        {
+            targets.push_back({ bot.id, World::BOT_TEAM, bot.GetRect() });
+        }
+
+        ProjectileSystem projectiles(count);
+        ParticleSystem particles(65536);
+        std::vector<ProjectileHit> hits;
+
+        runner.Run("projectiles/update", count, 5,
+            [&] {
+                FillProjectiles(projectiles, world.Env(), bounds, count);
+                particles.Clear();
+            },
+            [&](std::size_t) {
+                hits.clear();
+                projectiles.Update(TICK, world.Env(), targets, particles, hits);
+            });
+    }
+
+    // Same load resolved through a full lag-compensation window, every
+    // bullet rewound 100 ms against bots that wandered while it was kept.
+    for (const std::size_t count : { std::size_t{ 256 }, std::size_t{ 1024 }, std::size_t{ 4096 } })
+    {
+        if (!runner.Matches("projectiles/rewind")) break;
+
+        World world(16);
+        PopulateWorld(world, 1000, 64, 0);
+        const Rectangle bounds = LevelBounds(world.EnvItems());
+
+        HitboxHistory history(31);
+        std::vector<HitTarget> targets;
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<float> drift(-5.0f, 5.0f);
+        for (std::size_t frame = 0; frame < history.Capacity(); ++frame)
+        {
+            targets.clear();
+            for (auto& bot : world.Bots())
+            {
+                bot.position.x += drift(rng);
+                targets.push_back({ bot.id, World::BOT_TEAM, bot.GetRect() });
+            }
+            history.Store(targets);
+        }
+
+        ProjectileSystem projectiles(count);
+        ParticleSystem particles(65536);
+        std::vector<ProjectileHit> hits;
+
+        runner.Run("projectiles/rewind", count, 5,
+            [&] {
+                FillProjectiles(projectiles, world.Env(), bounds, count, 1, 6);
+                particles.Clear();
+            },
+            [&](std::size_t) {
+                hits.clear();
+                projectiles.Update(TICK, world.Env(), targets, particles, hits, &history);
+            });
+    }
+}
+
+static void BenchActors(BenchRunner& runner)
+{
+    for (const std::size_t count : ACTOR_COUNTS)
+    {
+        if (!runner.Matches("player/collision")) break;
+
+        std::unique_ptr<World> world;
+        std::vector<ScriptedInputSource> inputs;
+        runner.Run("player/collision", count, 60,
+            [&] {
+                world = std::make_unique<World>(16);
+                PopulateWorld(*world, 1000, 0, count);
+                inputs.clear();
+                for (std::size_t i = 0; i < count; ++i) inputs.emplace_back(static_cast<unsigned>(i + 1));
+            },
+            [&](std::size_t) {
+                auto& players = world->Players();
+                for (std::size_t i = 0; i < players.size(); ++i)
+                {
+                    players[i].Update(TICK, inputs[i].Sample(), world->Env());
+                }
+            });
+    }
+
+    for (const std::size_t count : ACTOR_COUNTS)
+    {
+        if (!runner.Matches("world/tick")) break;
+
+        std::unique_ptr<World> world;
+        std::vector<ScriptedInputSource> inputs;
+        runner.Run("world/tick", count, 60,
+            [&] {
+                world = std::make_unique<World>();
+                PopulateWorld(*world, 1000, count, 4);
+                inputs.clear();
+                for (std::size_t i = 0; i < 4; ++i) inputs.emplace_back(static_cast<unsigned>(i + 1));
+            },
+            [&](std::size_t) {
+                const auto& players = world->Players();
+                for (std::size_t i = 0; i < players.size(); ++i)
+                {
+                    world->SetInput(players[i].id, inputs[i].Sample());
+                }
+                world->Tick(TICK);
+            });
+    }
+}
+
+static void PrintUsage()
+{
+    std::printf("usage: War_bench [--filter substr] [--reps N] [--warmup N] [--json file]\n");
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--filter") == 0 && hasValue) options.filter = argv[++i];
+        else if (std::strcmp(argv[i], "--reps") == 0 && hasValue) options.repetitions = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--warmup") == 0 && hasValue) options.warmup = std::max(0, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--json") == 0 && hasValue) options.jsonPath = argv[++i];
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    const char* simd = SimdLevelName(DetectSimdLevel());
+    std::printf("War_bench  simd=%s  warmup=%d  reps=%d\n", simd, options.warmup, options.repetitions);
+
+    BenchRunner runner(options);
+    BenchEnvIndex(runner);
+    BenchBots(runner);
+    BenchParticles(runner);
+    BenchProjectiles(runner);
+    BenchActors(runner);
+
+    if (!options.jsonPath.empty())
+    {
+        if (!runner.WriteJson(options.jsonPath, simd))
+        {
+            std::fprintf(stderr, "failed to write %s\n", options.jsonPath.c_str());
+            return 1;
+        }
+        std::printf("wrote %s\n", options.jsonPath.c_str());
+    }
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "Scenarios.h"
+#include "World.h"
+#include "ParticleSystem.h"
+#include "ProjectileSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+// The shipped level puts 9 platforms in a 2000x700 arena.
+static constexpr float AREA_PER_PLATFORM = 2000.0f * 700.0f / 9.0f;
+static constexpr float MAX_EXTENT = 4800.0f;
+static constexpr float WALL = 10.0f;
+
+std::vector<EnvItem> MakeLevel(const std::size_t platformCount, const unsigned seed)
+{
+    std::mt19937 rng(seed);
+
+    const float area = AREA_PER_PLATFORM * static_cast<float>(std::max<std::size_t>(platformCount, 1));
+    const float width  = std::clamp(sqrtf(area * 2000.0f / 700.0f), 2000.0f, MAX_EXTENT);
+    const float height = std::clamp(area / width, 700.0f, MAX_EXTENT);
+
+    std::vector<EnvItem> items;
+    items.reserve(platformCount + 4);
+    items.push_back({ { 0, 0, width, WALL }, 1, GRAY });
+    items.push_back({ { 0, 0, WALL, height }, 1, GRAY });
+    items.push_back({ { width - WALL, 0, WALL, height }, 1, GRAY });
+    items.push_back({ { 0, height - WALL, width, WALL }, 1, GRAY });
+
+    std::uniform_real_distribution<float> w(100.0f, 400.0f);
+    std::uniform_real_distribution<float> h(20.0f, 60.0f);
+    std::uniform_real_distribution<float> x(WALL, width - WALL);
+    std::uniform_real_distribution<float> y(WALL, height - WALL);
+
+    for (std::size_t i = 0; i < platformCount; ++i)
+    {
+        Rectangle rect{ x(rng), y(rng), w(rng), h(rng) };
+        rect.width  = std::min(rect.width,  width  - WALL - rect.x);
+        rect.height = std::min(rect.height, height - WALL - rect.y);
+        items.push_back({ rect, 1, GRAY });
+    }
+
+    return items;
+}
+
+Rectangle LevelBounds(const std::vector<EnvItem>& items)
+{
+    float maxX = 0.0f;
+    float maxY = 0.0f;
+    for (const auto& item : items)
+    {
+        maxX = std::max(maxX, item.rect.x + item.rect.width);
+        maxY = std::max(maxY, item.rect.y + item.rect.height);
+    }
+    return { WALL, WALL, maxX - 2.0f * WALL, maxY - 2.0f * WALL };
+}
+
+Vector2 FindFreeSpot(const EnvIndex& env, const Rectangle& bounds, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> x(bounds.x + 20.0f, bounds.x + bounds.width - 20.0f);
+    std::uniform_real_distribution<float> y(bounds.y + 80.0f, bounds.y + bounds.height - 20.0f);
+
+    static thread_local std::vector<int> hits;
+    Vector2 spot{};
+    for (int attempt = 0; attempt < 64; ++attempt)
+    {
+        spot = { x(rng), y(rng) };
+        env.QueryRect({ spot.x - 12.0f, spot.y - 64.0f, 24.0f, 66.0f }, hits);
+        if (hits.empty())
+        {
+            break;
+        }
+    }
+    return spot;
+}
+
+void PopulateWorld(World& world, const std::size_t platformCount, const std::size_t botCount,
+                   const std::size_t playerCount, const unsigned seed)
+{
+    world.LoadLevel(MakeLevel(platformCount, seed));
+
+    std::mt19937 rng(seed * 7919u + 1u);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const Rectangle bounds = LevelBounds(world.EnvItems());
+
+    for (std::size_t i = 0; i < playerCount; ++i)
+    {
+        world.AddPlayer(FindFreeSpot(world.Env(), bounds, rng));
+    }
+    for (std::size_t i = 0; i < botCount; ++i)
+    {
+        world.AddBot(FindFreeSpot(world.Env(), bounds, rng), unit(rng), unit(rng));
+    }
+}
+
+void FillParticles(ParticleSystem& particles, const std::size_t count, const unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> pos(0.0f, 2000.0f);
+    std::uniform_real_distribution<float> vel(-240.0f, 240.0f);
+    std::uniform_real_distribution<float> life(0.18f, 0.9f);
+
+    particles.Clear();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        particles.Emit({ pos(rng), pos(rng) }, { vel(rng), vel(rng) }, life(rng), 3.0f, ORANGE);
+    }
+}
+
+void FillProjectiles(ProjectileSystem& projectiles, const EnvIndex& env,
+                     const Rectangle& bounds, const std::size_t count, const unsigned seed,
+                     const std::uint16_t rewindTicks)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> angle(0.0f, 6.28318530718f);
+
+    projectiles.Clear();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const Vector2 pos = FindFreeSpot(env, bounds, rng);
+        const float a = angle(rng);
+        projectiles.Spawn(static_cast<std::uint32_t>(1000000 + i), World::PLAYER_TEAM,
+                          pos, { cosf(a) * 1600.0f, sinf(a) * 1600.0f }, World::PLAYER_BULLET_DAMAGE,
+                          rewindTicks);
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "raylib.h"
+#include "EnvIndex.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+class World;
+class ParticleSystem;
+class ProjectileSystem;
+
+// Deterministic synthetic content for the benchmarks. Everything is seeded so
+// two runs (or two builds being compared) see identical scenes.
+
+// Walled arena with `platformCount` random platforms. The arena grows with
+// the count so density stays close to the shipped level's, up to the
+// projectile world limit.
+std::vector<EnvItem> MakeLevel(std::size_t platformCount, unsigned seed = 1);
+
+Rectangle LevelBounds(const std::vector<EnvItem>& items);
+
+// Random point inside `bounds` whose actor-sized box overlaps no geometry.
+Vector2 FindFreeSpot(const EnvIndex& env, const Rectangle& bounds, std::mt19937& rng);
+
+void PopulateWorld(World& world, std::size_t platformCount, std::size_t botCount,
+                   std::size_t playerCount, unsigned seed = 1);
+
+void FillParticles(ParticleSystem& particles, std::size_t count, unsigned seed = 1);
+
+void FillProjectiles(ProjectileSystem& projectiles, const EnvIndex& env,
+                     const Rectangle& bounds, std::size_t count, unsigned seed = 1,
+                     std::uint16_t rewindTicks = 0);
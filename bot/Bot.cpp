@@ -1,51 +1,17 @@
 #include "Bot.h"
-#include "Game.h"
-#include "Particle.h"
+#include "EnvIndex.h"
+#include "ProjectileSystem.h"
+#include "ShapeBatch.h"
 #include "raylib.h"
+#include "Profiler.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 
-static float RaySegmentT(const Vector2 O, const Vector2 D,
-                          const Vector2 A, const Vector2 B,
-                          const float maxT)
-{
-    const float ex = B.x - A.x, ey = B.y - A.y;
-    const float denom = D.x * ey - D.y * ex;
-    if (fabsf(denom) < 1e-6f) return -1.0f;
-
-    const float fx = A.x - O.x, fy = A.y - O.y;
-    const float t  = (fx * ey - fy * ex) / denom;
-    const float s  = (fx * D.y - fy * D.x) / denom;
-
-    if (t < 0.0f || t > maxT || s < 0.0f || s > 1.0f) return -1.0f;
-    return t;
-}
-
-static float CastRay(const Vector2 origin, const Vector2 dir, const float maxDist,
-                     const std::vector<EnvItem>& envItems)
-{
-    float minT = maxDist;
-    for (const auto& [rect, blocking, color] : envItems)
-    {
-        if (!blocking) continue;
-        const Vector2 corners[4] = {
-            { rect.x,              rect.y               },
-            { rect.x + rect.width, rect.y               },
-            { rect.x + rect.width, rect.y + rect.height },
-            { rect.x,              rect.y + rect.height }
-        };
-        for (int e = 0; e < 4; ++e)
-        {
-            const float t = RaySegmentT(origin, dir, corners[e], corners[(e + 1) % 4], minT);
-            if (t >= 0.0f && t < minT) minT = t;
-        }
-    }
-    return minT;
-}
-
 Bot::Bot(const Vector2 startPos, const float difficulty, const float aggression)
     : position(startPos),
+      previousPosition(startPos),
       speed(0.0f),
       canJump(false),
       health(100),
@@ -62,8 +28,7 @@ Bot::Bot(const Vector2 startPos, const float difficulty, const float aggression)
       patrolDir(1.0f)
 {}
 
-bool Bot::HasLineOfSight(const Vector2 playerPos,
-                         const std::vector<EnvItem>& envItems) const
+bool Bot::HasLineOfSight(const Vector2 playerPos, const EnvIndex& env) const
 {
     const Vector2 botEye    = { position.x,  position.y  - 40.0f };
     const Vector2 playerEye = { playerPos.x, playerPos.y - 40.0f };
@@ -74,24 +39,104 @@ bool Bot::HasLineOfSight(const Vector2 playerPos,
     if (dist < 1e-4f) return true;
 
     const Vector2 dir = { dx / dist, dy / dist };
-    return CastRay(botEye, dir, dist, envItems) >= dist - 1.0f;
+    return env.CastRay(botEye, dir, dist) >= dist - 1.0f;
+}
+
+void Bot::ApplyReplicatedState(const Vector2 pos, const int newHealth, const BotState newState)
+{
+    previousPosition = position;
+    position = pos;
+    health = newHealth;
+    state = newState;
 }
 
-void Bot::ComputeVisibilityPolygon(const std::vector<EnvItem>& envItems)
+void Bot::ComputeVisibilityPolygon(const EnvIndex& env)
 {
-    constexpr int RAY_COUNT = 180;
     constexpr float TWO_PI  = 6.28318530718f;
+    constexpr float EPSILON = 1e-4f;
 
     const Vector2 eye = { position.x, position.y - 40.0f };
 
-    visibilityPolygon.clear();
-    visibilityPolygon.reserve(RAY_COUNT);
+    const float mdx = eye.x - visibilityEye.x;
+    const float mdy = eye.y - visibilityEye.y;
+    if (visibilityRadius == visionRadius && !visibilityPolygon.empty() &&
+        mdx * mdx + mdy * mdy < VISION_REBUILD_DISTANCE * VISION_REBUILD_DISTANCE)
+    {
+        return;
+    }
+
+    visibilityEye    = eye;
+    visibilityRadius = visionRadius;
+
+    static thread_local std::vector<int> nearby;
+    env.QueryCircle(eye, visionRadius, nearby);
+
+    visibilityAngles.clear();
+
+    // The outline only changes direction at block corners and where block
+    // edges cross the vision circle; everything else is arc.
+    for (int i = 0; i < VISION_ARC_SEGMENTS; ++i)
+    {
+        visibilityAngles.push_back(TWO_PI * static_cast<float>(i) / static_cast<float>(VISION_ARC_SEGMENTS));
+    }
 
-    for (int i = 0; i < RAY_COUNT; ++i)
+    const auto addCritical = [&](const float x, const float y) {
+        const float angle = atan2f(y - eye.y, x - eye.x);
+        visibilityAngles.push_back(angle - EPSILON);
+        visibilityAngles.push_back(angle);
+        visibilityAngles.push_back(angle + EPSILON);
+    };
+
+    const float r2 = visionRadius * visionRadius;
+    for (const int index : nearby)
+    {
+        const Rectangle& rect = env.Item(index).rect;
+        const Vector2 corners[4] = {
+            { rect.x,              rect.y               },
+            { rect.x + rect.width, rect.y               },
+            { rect.x + rect.width, rect.y + rect.height },
+            { rect.x,              rect.y + rect.height }
+        };
+
+        for (int c = 0; c < 4; ++c)
+        {
+            const Vector2& a = corners[c];
+            const Vector2& b = corners[(c + 1) % 4];
+
+            const float ax = a.x - eye.x, ay = a.y - eye.y;
+            if (ax * ax + ay * ay <= r2) addCritical(a.x, a.y);
+
+            const float ex = b.x - a.x, ey = b.y - a.y;
+            const float qa = ex * ex + ey * ey;
+            const float qb = ax * ex + ay * ey;
+            const float qc = ax * ax + ay * ay - r2;
+            const float disc = qb * qb - qa * qc;
+            if (qa < 1e-6f || disc < 0.0f) continue;
+
+            const float root = sqrtf(disc);
+            for (const float t : { (-qb - root) / qa, (-qb + root) / qa })
+            {
+                if (t >= 0.0f && t <= 1.0f) addCritical(a.x + ex * t, a.y + ey * t);
+            }
+        }
+    }
+
+    for (float& angle : visibilityAngles)
+    {
+        if (angle < 0.0f) angle += TWO_PI;
+        else if (angle >= TWO_PI) angle -= TWO_PI;
+    }
+    std::sort(visibilityAngles.begin(), visibilityAngles.end());
+
+    visibilityPolygon.clear();
+    float previous = -1.0f;
+    for (const float angle : visibilityAngles)
     {
-        const float angle = TWO_PI * static_cast<float>(i) / static_cast<float>(RAY_COUNT);
+        if (angle - previous < EPSILON * 0.5f) continue;
+        previous = angle;
+
         const Vector2 dir = { cosf(angle), sinf(angle) };
-        const float   hit = CastRay(eye, dir, visionRadius, envItems);
+        const float   hit = env.CastRay(eye, dir, visionRadius);
         visibilityPolygon.push_back({ eye.x + dir.x * hit, eye.y + dir.y * hit });
     }
 }
@@ -103,9 +148,11 @@ Rectangle Bot::GetRect() const
     return { position.x - halfWidth, position.y - fullHeight, halfWidth * 2.0f, fullHeight };
 }
 
-void Bot::Update(const float delta, const std::vector<EnvItem>& envItems,
-                 const Vector2 playerPos, std::vector<Particle>& particles)
+void Bot::Update(const float delta, const EnvIndex& env,
+                 const Vector2 playerPos, ProjectileSystem& projectiles)
 {
+    previousPosition = position;
+
     if (IsDead()) return;
 
     constexpr float halfWidth  = 10.0f;
@@ -116,13 +163,16 @@ void Bot::Update(const float delta, const std::vector<EnvItem>& envItems,
     const float dist = sqrtf(dx * dx + dy * dy);
 
     const bool playerVisible = (dist <= visionRadius) &&
-                               HasLineOfSight(playerPos, envItems);
+                               HasLineOfSight(playerPos, env);
 
     lastPlayerPos = playerPos;
     lastHasLOS    = playerVisible;
 
     if (showVisionDebug)
-        ComputeVisibilityPolygon(envItems);
+    {
+        PROFILE_SCOPE("Bot vision");
+        ComputeVisibilityPolygon(env);
+    }
 
     if (playerVisible)
     {
@@ -193,9 +243,13 @@ void Bot::Update(const float delta, const std::vector<EnvItem>& envItems,
 
     bool grounded = false;
 
-    for (const auto& [rect, blocking, color] : envItems)
+    static thread_local std::vector<int> candidates;
+    env.QueryRect({ botRect.x - halfWidth * 2.0f, botRect.y - fullHeight,
+                    botRect.width + halfWidth * 4.0f, botRect.height + fullHeight * 2.0f }, candidates);
+
+    for (const int index : candidates)
     {
-        if (!blocking) continue;
+        const Rectangle& rect = env.Item(index).rect;
 
         if (CheckCollisionRecs(rect, botRect))
         {
@@ -238,16 +292,21 @@ void Bot::Update(const float delta, const std::vector<EnvItem>& envItems,
     canJump = grounded;
 
     const Vector2 anchor = { position.x, position.y - 35.0f };
-    weapon.Update(delta, anchor, playerPos, envItems, particles, 0.0f, shouldFire);
+    weapon.Update(delta, anchor, playerPos, projectiles, 0.0f, shouldFire);
 }
 
-void Bot::Draw() const
+void Bot::Draw(ShapeBatch& batch, const float alpha) const
 {
     if (IsDead()) return;
 
     constexpr float halfWidth  = 10.0f;
     constexpr float fullHeight = 60.0f;
 
+    const Vector2 renderPos = {
+        previousPosition.x + (position.x - previousPosition.x) * alpha,
+        previousPosition.y + (position.y - previousPosition.y) * alpha
+    };
+
     Color bodyColor;
     switch (state)
     {
@@ -260,39 +319,39 @@ void Bot::Draw() const
 
     if (showVisionDebug && visibilityPolygon.size() >= 3)
     {
-        const Vector2 eye = { position.x, position.y - 40.0f };
+        const Vector2 eye = { renderPos.x, renderPos.y - 40.0f };
 
         for (int i = 0, n = static_cast<int>(visibilityPolygon.size()); i < n; ++i)
         {
             const Vector2& a = visibilityPolygon[i];
             const Vector2& b = visibilityPolygon[(i + 1) % n];
-            DrawTriangle(eye, b, a, Color{ 255, 255, 0, 28 });
+            batch.AddTriangle(visibilityEye, b, a, Color{ 255, 255, 0, 28 });
         }
 
         for (int i = 0, n = static_cast<int>(visibilityPolygon.size()); i < n; ++i)
         {
             const Vector2& a = visibilityPolygon[i];
             const Vector2& b = visibilityPolygon[(i + 1) % n];
-            DrawLineV(a, b, Color{ 255, 220, 0, 160 });
+            batch.AddLine(a, b, 1.0f, Color{ 255, 220, 0, 160 });
         }
 
         const Vector2 playerEye = { lastPlayerPos.x, lastPlayerPos.y - 40.0f };
         const Color   losColor  = lastHasLOS ? Color{ 0, 255, 80, 220 }
                                              : Color{ 255, 50, 50, 220 };
-        DrawLineV(eye, playerEye, losColor);
-        DrawCircleV(playerEye, 4.0f, losColor);
+        batch.AddLine(eye, playerEye, 1.0f, losColor);
+        batch.AddCircle(playerEye, 4.0f, losColor);
     }
 
-    const Rectangle r = { position.x - halfWidth, position.y - fullHeight,
+    const Rectangle r = { renderPos.x - halfWidth, renderPos.y - fullHeight,
                            halfWidth * 2.0f, fullHeight };
-    DrawRectangleRec(r, bodyColor);
+    batch.AddRect(r, bodyColor);
 
     const float barWidth = halfWidth * 2.0f;
-    const float barX     = position.x - barWidth / 2.0f;
-    const float barY     = position.y - fullHeight - 11.0f;
-    DrawRectangleRec({ barX - 1.0f, barY - 1.0f, barWidth + 2.0f, 7.0f }, DARKGRAY);
+    const float barX     = renderPos.x - barWidth / 2.0f;
+    const float barY     = renderPos.y - fullHeight - 11.0f;
+    batch.AddRect({ barX - 1.0f, barY - 1.0f, barWidth + 2.0f, 7.0f }, DARKGRAY);
     const float ratio = (maxHealth > 0) ? static_cast<float>(health) / static_cast<float>(maxHealth) : 0.0f;
-    DrawRectangleRec({ barX, barY, barWidth * ratio, 5.0f }, RED);
+    batch.AddRect({ barX, barY, barWidth * ratio, 5.0f }, RED);
 
-    weapon.Draw();
+    weapon.Draw(batch, Vector2{ renderPos.x - position.x, renderPos.y - position.y });
 }
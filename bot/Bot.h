@@ -2,9 +2,11 @@
 #include "raylib.h"
 #include <vector>
 #include "Weapon.h"
+#include <cstdint>
 
-struct EnvItem;
-class Particle;
+class EnvIndex;
+class ProjectileSystem;
+class ShapeBatch;
 
 enum class BotState {
     IDLE,
@@ -18,7 +20,10 @@ class Bot
 public:
     Bot(Vector2 startPos, float difficulty = 0.5f, float aggression = 0.5f);
 
+    std::uint32_t id = 0;
+
     Vector2 position;
+    Vector2 previousPosition;
     float   speed;
     bool    canJump;
 
@@ -39,12 +44,17 @@ public:
     [[nodiscard]] Rectangle GetRect() const;
     [[nodiscard]] bool IsDead() const { return health <= 0; }
 
-    void Update(float delta, const std::vector<EnvItem>& envItems,
-                Vector2 playerPos, std::vector<Particle>& particles);
-    void Draw() const;
+    void Update(float delta, const EnvIndex& env,
+                Vector2 playerPos, ProjectileSystem& projectiles);
+    void Draw(ShapeBatch& batch, float alpha = 1.0f) const;
 
     [[nodiscard]] BotState GetState() const { return state; }
 
+    // Replica bots on a networked client take their state from server
+    // snapshots instead of running Update.
+    void ApplyReplicatedState(Vector2 pos, int newHealth, BotState newState);
+    [[nodiscard]] bool HasLineOfSight(Vector2 playerPos, const EnvIndex& env) const;
+
 private:
     BotState state;
     float idleTimer;
@@ -55,13 +65,17 @@ private:
     bool    lastHasLOS    = false;
 
     std::vector<Vector2> visibilityPolygon; 
+    std::vector<float>   visibilityAngles;
+    Vector2 visibilityEye    = { 0.0f, 0.0f };
+    float   visibilityRadius = -1.0f;
 
-    [[nodiscard]] bool HasLineOfSight(Vector2 playerPos,
-                                      const std::vector<EnvItem>& envItems) const;
-    void ComputeVisibilityPolygon(const std::vector<EnvItem>& envItems);
+    void ComputeVisibilityPolygon(const EnvIndex& env);
 
     static constexpr float ATTACK_RANGE = 450.0f;
     static constexpr float HOR_SPEED    = 290.0f;
     static constexpr float JUMP_SPEED   = 500.0f;
     static constexpr float GRAVITY      = 600.0f;
+
+    static constexpr float VISION_REBUILD_DISTANCE = 4.0f;
+    static constexpr int   VISION_ARC_SEGMENTS     = 32;
 };
@@ -0,0 +1,315 @@
+#include "Log.h"
+#include "SpscQueue.h"
+
+#include <algorithm>
+#include <chrono>
+
+// How long the writer sleeps between passes when nothing asks for it sooner.
+static constexpr std::chrono::milliseconds WRITER_INTERVAL{ 10 };
+
+struct Log::ThreadBuffer
+{
+    explicit ThreadBuffer(const std::uint32_t threadId)
+        : threadId(threadId) {}
+
+    std::uint32_t threadId;
+
+    // Produced only by the owning thread, consumed only by the writer.
+    SpscQueue<LogRecord, RING_CAPACITY> ring;
+    std::atomic<std::uint64_t> dropped{ 0 };
+};
+
+std::atomic<std::uint8_t> Log::minLevel{ static_cast<std::uint8_t>(LogLevel::Info) };
+
+static const char* LevelName(const LogLevel level)
+{
+    switch (level)
+    {
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info:  return "INFO ";
+        case LogLevel::Warn:  return "WARN ";
+        case LogLevel::Error: return "ERROR";
+    }
+    return "?    ";
+}
+
+void LogRecord::AddText(const std::string_view value)
+{
+    const std::size_t length = std::min(value.size(), TEXT_CAPACITY - textUsed);
+    std::memcpy(text.data() + textUsed, value.data(), length);
+
+    types[argCount] = ArgType::Text;
+    args[argCount] = (static_cast<std::uint64_t>(textUsed) << 32) | length;
+    textUsed = static_cast<std::uint8_t>(textUsed + length);
+    ++argCount;
+}
+
+Log& Log::Get()
+{
+    static Log instance;
+    return instance;
+}
+
+Log::Log()
+    : startNs(NowNs())
+{
+    writer = std::thread(&Log::WriterLoop, this);
+}
+
+Log::~Log()
+{
+    {
+        std::lock_guard lock(writerMutex);
+        stopping = true;
+    }
+    writerWake.notify_one();
+    writer.join();
+
+    if (file)
+    {
+        std::fclose(file);
+    }
+}
+
+std::uint64_t Log::NowNs()
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Log::SetLevel(const LogLevel level)
+{
+    minLevel.store(static_cast<std::uint8_t>(level), std::memory_order_relaxed);
+}
+
+bool Log::ParseLevel(const std::string_view name, LogLevel& level)
+{
+    if (name == "debug") level = LogLevel::Debug;
+    else if (name == "info") level = LogLevel::Info;
+    else if (name == "warn") level = LogLevel::Warn;
+    else if (name == "error") level = LogLevel::Error;
+    else return false;
+    return true;
+}
+
+bool Log::SetFile(const std::string& path)
+{
+    std::FILE* opened = nullptr;
+    if (!path.empty())
+    {
+        opened = std::fopen(path.c_str(), "a");
+        if (!opened)
+        {
+            return false;
+        }
+    }
+
+    std::lock_guard lock(writerMutex);
+    if (file)
+    {
+        std::fclose(file);
+    }
+    file = opened;
+    return true;
+}
+
+bool Log::Admit(LogSite& site, const std::uint64_t nowNs, std::uint32_t& suppressed)
+{
+    // Window 0 means the site has never logged.
+    const std::uint64_t window = nowNs / 1'000'000'000 + 1;
+    std::uint64_t seen = site.window.load(std::memory_order_relaxed);
+    if (seen != window && site.window.compare_exchange_strong(seen, window, std::memory_order_relaxed))
+    {
+        site.passed.store(0, std::memory_order_relaxed);
+    }
+
+    if (site.passed.fetch_add(1, std::memory_order_relaxed) < SITE_RATE_LIMIT)
+    {
+        suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+    site.suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+Log::ThreadBuffer& Log::LocalBuffer()
+{
+    thread_local ThreadBuffer* local = nullptr;
+    if (!local)
+    {
+        std::lock_guard lock(buffersMutex);
+        buffers.push_back(std::make_unique<ThreadBuffer>(static_cast<std::uint32_t>(buffers.size())));
+        local = buffers.back().get();
+    }
+    return *local;
+}
+
+void Log::Push(LogRecord& record)
+{
+    ThreadBuffer& buffer = LocalBuffer();
+    record.threadId = buffer.threadId;
+    if (!buffer.ring.TryPush(record))
+    {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (record.level == LogLevel::Error)
+    {
+        writerWake.notify_one();
+    }
+}
+
+void Log::Flush()
+{
+    std::unique_lock lock(writerMutex);
+    const std::uint64_t ticket = ++flushRequested;
+    writerWake.notify_one();
+    flushed.wait(lock, [&] { return flushCompleted >= ticket; });
+}
+
+std::uint64_t Log::DroppedCount() const
+{
+    std::lock_guard lock(buffersMutex);
+    std::uint64_t total = 0;
+    for (const auto& buffer : buffers)
+    {
+        total += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void Log::WriterLoop()
+{
+    std::vector<LogRecord> batch;
+    std::string line;
+
+    std::unique_lock lock(writerMutex);
+    while (true)
+    {
+        // Read before draining: everything logged before a Flush() or the
+        // destructor is then already in the rings.
+        const std::uint64_t request = flushRequested;
+        const bool stop = stopping;
+
+        lock.unlock();
+        Drain(batch);
+        lock.lock();
+
+        Emit(batch, line);
+        flushCompleted = request;
+        flushed.notify_all();
+
+        if (stop)
+        {
+            break;
+        }
+        if (!stopping && flushRequested == flushCompleted)
+        {
+            writerWake.wait_for(lock, WRITER_INTERVAL);
+        }
+    }
+}
+
+void Log::Drain(std::vector<LogRecord>& batch)
+{
+    batch.clear();
+    {
+        std::lock_guard lock(buffersMutex);
+        for (const auto& buffer : buffers)
+        {
+            while (auto record = buffer->ring.TryPop())
+            {
+                batch.push_back(*record);
+            }
+        }
+    }
+
+    // Each ring is in order already; this interleaves the threads.
+    std::stable_sort(batch.begin(), batch.end(),
+                     [](const LogRecord& a, const LogRecord& b) { return a.timeNs < b.timeNs; });
+}
+
+static void AppendArg(std::string& line, const LogRecord& record, const std::size_t index)
+{
+    char number[32];
+    const std::uint64_t value = record.args[index];
+    switch (record.types[index])
+    {
+        case LogRecord::ArgType::Int:
+            std::snprintf(number, sizeof(number), "%lld", static_cast<long long>(static_cast<std::int64_t>(value)));
+            line += number;
+            break;
+        case LogRecord::ArgType::Uint:
+            std::snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(value));
+            line += number;
+            break;
+        case LogRecord::ArgType::Float:
+        {
+            double d;
+            std::memcpy(&d, &value, sizeof(d));
+            std::snprintf(number, sizeof(number), "%g", d);
+            line += number;
+            break;
+        }
+        case LogRecord::ArgType::Bool:
+            line += value ? "true" : "false";
+            break;
+        case LogRecord::ArgType::Text:
+            line.append(record.text.data() + (value >> 32), value & 0xFFFFFFFFu);
+            break;
+    }
+}
+
+void Log::Emit(const std::vector<LogRecord>& batch, std::string& line)
+{
+    bool wroteOut = false;
+    bool wroteErr = false;
+    const auto write = [&](const LogLevel level) {
+        std::FILE* sink = file ? file : level >= LogLevel::Warn ? stderr : stdout;
+        std::fwrite(line.data(), 1, line.size(), sink);
+        (sink == stderr ? wroteErr : wroteOut) = true;
+    };
+
+    char prefix[64];
+    for (const LogRecord& record : batch)
+    {
+        const double seconds = static_cast<double>(record.timeNs - std::min(record.timeNs, startNs)) * 1e-9;
+        std::snprintf(prefix, sizeof(prefix), "[%11.6f] %s t%-3u ", seconds, LevelName(record.level), record.threadId);
+        line = prefix;
+
+        std::size_t arg = 0;
+        for (const char* c = record.format; *c; ++c)
+        {
+            if (c[0] == '{' && c[1] == '}' && arg < record.argCount)
+            {
+                AppendArg(line, record, arg++);
+                ++c;
+            }
+            else
+            {
+                line += *c;
+            }
+        }
+
+        if (record.suppressed > 0)
+        {
+            std::snprintf(prefix, sizeof(prefix), " (%u similar suppressed)", record.suppressed);
+            line += prefix;
+        }
+        line += '\n';
+        write(record.level);
+    }
+
+    if (const std::uint64_t drops = DroppedCount(); drops != reportedDrops)
+    {
+        std::snprintf(prefix, sizeof(prefix), "[log] %llu messages dropped, rings full\n",
+                      static_cast<unsigned long long>(drops - reportedDrops));
+        line = prefix;
+        reportedDrops = drops;
+        write(LogLevel::Warn);
+    }
+
+    if (wroteOut) std::fflush(file ? file : stdout);
+    if (wroteErr) std::fflush(stderr);
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+enum class LogLevel : std::uint8_t
+{
+    Debug,
+    Info,
+    Warn,
+    Error,
+};
+
+// Per call site state for LOG_* rate limiting: each site passes at most
+// Log::SITE_RATE_LIMIT messages per second, and the next one that gets
+// through reports how many were held back in between.
+struct LogSite
+{
+    std::atomic<std::uint64_t> window{ 0 };
+    std::atomic<std::uint32_t> passed{ 0 };
+    std::atomic<std::uint32_t> suppressed{ 0 };
+};
+
+// One message as the hot path leaves it: the format string by pointer and the
+// arguments still in binary form. Formatting happens on the writer thread.
+struct LogRecord
+{
+    enum class ArgType : std::uint8_t { Int, Uint, Float, Bool, Text };
+
+    static constexpr std::size_t MAX_ARGS = 8;
+    static constexpr std::size_t TEXT_CAPACITY = 96;
+
+    std::uint64_t timeNs = 0;
+    const char* format = nullptr;
+    std::uint32_t suppressed = 0;
+    std::uint32_t threadId = 0;
+    LogLevel level = LogLevel::Info;
+    std::uint8_t argCount = 0;
+    std::uint8_t textUsed = 0;
+    std::array<ArgType, MAX_ARGS> types{};
+    std::array<std::uint64_t, MAX_ARGS> args{};
+    std::array<char, TEXT_CAPACITY> text{};
+
+    template <typename T>
+    void Add(const T& value);
+
+private:
+    void AddText(std::string_view value);
+};
+
+// Asynchronous logger. LOG_INFO("Client {} connected", id) copies its
+// arguments into the calling thread's ring buffer and returns; a background
+// thread formats and writes them, so a slow terminal or disk never stalls a
+// network or simulation thread. A full ring drops the message and counts it
+// instead of waiting. `{}` in the format string takes the next argument; the
+// format must be a string literal, as only its address is kept.
+class Log
+{
+public:
+    static Log& Get();
+
+    [[nodiscard]] static std::uint64_t NowNs();
+
+    [[nodiscard]] static bool Enabled(const LogLevel level)
+    {
+        return static_cast<std::uint8_t>(level) >= minLevel.load(std::memory_order_relaxed);
+    }
+    static void SetLevel(LogLevel level);
+    [[nodiscard]] static bool ParseLevel(std::string_view name, LogLevel& level);
+
+    // Sends every message to `path` instead of stdout (Debug, Info) and
+    // stderr (Warn, Error). An empty path goes back to the console.
+    bool SetFile(const std::string& path);
+
+    template <typename... Args>
+    void Write(LogSite& site, const LogLevel level, const char* format, const Args&... args)
+    {
+        static_assert(sizeof...(Args) <= LogRecord::MAX_ARGS, "too many log arguments");
+
+        LogRecord record;
+        record.timeNs = NowNs();
+        if (!Admit(site, record.timeNs, record.suppressed)) return;
+
+        record.format = format;
+        record.level = level;
+        (record.Add(args), ...);
+        Push(record);
+    }
+
+    // Blocks until everything logged before the call has been written.
+    void Flush();
+
+    // Messages lost to full rings since startup.
+    [[nodiscard]] std::uint64_t DroppedCount() const;
+
+    static constexpr std::size_t RING_CAPACITY = 1 << 10;
+    static constexpr std::uint32_t SITE_RATE_LIMIT = 20;
+
+    ~Log();
+
+private:
+    struct ThreadBuffer;
+
+    Log();
+
+    static bool Admit(LogSite& site, std::uint64_t nowNs, std::uint32_t& suppressed);
+    void Push(LogRecord& record);
+    ThreadBuffer& LocalBuffer();
+
+    void WriterLoop();
+    void Drain(std::vector<LogRecord>& batch);
+    void Emit(const std::vector<LogRecord>& batch, std::string& line);
+
+    static std::atomic<std::uint8_t> minLevel;
+
+    std::uint64_t startNs;
+
+    mutable std::mutex buffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+    // Guards the sink and the writer's sleep; never taken by Write. An error
+    // only notifies writerWake so it shows up without the usual delay.
+    std::mutex writerMutex;
+    std::condition_variable writerWake;
+    std::condition_variable flushed;
+    std::uint64_t flushRequested = 0;
+    std::uint64_t flushCompleted = 0;
+    bool stopping = false;
+    std::FILE* file = nullptr;
+    std::uint64_t reportedDrops = 0;
+    std::thread writer;
+};
+
+template <typename T>
+void LogRecord::Add(const T& value)
+{
+    using V = std::decay_t<T>;
+    if (argCount == MAX_ARGS) return;
+
+    if constexpr (std::is_same_v<V, bool>)
+    {
+        types[argCount] = ArgType::Bool;
+        args[argCount] = value ? 1 : 0;
+    }
+    else if constexpr (std::is_enum_v<V>)
+    {
+        Add(static_cast<std::underlying_type_t<V>>(value));
+        return;
+    }
+    else if constexpr (std::is_integral_v<V> && std::is_signed_v<V>)
+    {
+        types[argCount] = ArgType::Int;
+        args[argCount] = static_cast<std::uint64_t>(static_cast<std::int64_t>(value));
+    }
+    else if constexpr (std::is_integral_v<V>)
+    {
+        types[argCount] = ArgType::Uint;
+        args[argCount] = static_cast<std::uint64_t>(value);
+    }
+    else if constexpr (std::is_floating_point_v<V>)
+    {
+        const double d = static_cast<double>(value);
+        types[argCount] = ArgType::Float;
+        std::memcpy(&args[argCount], &d, sizeof(d));
+    }
+    else if constexpr (std::is_pointer_v<V>)
+    {
+        static_assert(std::is_same_v<std::remove_cv_t<std::remove_pointer_t<V>>, char>, "unsupported log argument type");
+        // Char arrays land here too, decayed.
+        const char* const text = value;
+        AddText(text ? std::string_view(text) : std::string_view("(null)"));
+        return;
+    }
+    else
+    {
+        static_assert(std::is_convertible_v<const V&, std::string_view>, "unsupported log argument type");
+        AddText(std::string_view(value));
+        return;
+    }
+    ++argCount;
+}
+
+#define WAR_LOG(level, format, ...)                                     \
+    do                                                                  \
+    {                                                                   \
+        if (Log::Enabled(level))                                        \
+        {                                                               \
+            static LogSite logSite_;                                    \
+            Log::Get().Write(logSite_, level, format, ##__VA_ARGS__);   \
+        }                                                               \
+    } while (0)
+
+#define LOG_DEBUG(format, ...) WAR_LOG(LogLevel::Debug, format, ##__VA_ARGS__)
+#define LOG_INFO(format, ...) WAR_LOG(LogLevel::Info, format, ##__VA_ARGS__)
+#define LOG_WARN(format, ...) WAR_LOG(LogLevel::Warn, format, ##__VA_ARGS__)
+#define LOG_ERROR(format, ...) WAR_LOG(LogLevel::Error, format, ##__VA_ARGS__)
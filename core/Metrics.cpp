@@ -0,0 +1,133 @@
+#include "Metrics.h"
+
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <utility>
+
+std::size_t Histogram::BucketOf(const std::uint64_t value)
+{
+    if (value < 4) return static_cast<std::size_t>(value);
+
+    const int exponent = std::bit_width(value) - 1;
+    const std::uint64_t sub = (value >> (exponent - 2)) & 3;
+    return static_cast<std::size_t>(exponent - 1) * 4 + static_cast<std::size_t>(sub);
+}
+
+std::uint64_t Histogram::BucketLow(const std::size_t bucket)
+{
+    if (bucket < 4) return bucket;
+
+    const std::size_t exponent = bucket / 4 + 1;
+    return (4 + static_cast<std::uint64_t>(bucket % 4)) << (exponent - 2);
+}
+
+void Histogram::Record(const std::uint64_t value)
+{
+    counts[BucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::Take() const
+{
+    Snapshot snapshot;
+    for (std::size_t i = 0; i < BUCKETS; ++i)
+    {
+        snapshot.counts[i] = counts[i].load(std::memory_order_relaxed);
+    }
+    snapshot.sum = sum.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+Histogram::Summary Histogram::Summarize(const Snapshot& now, const Snapshot& before)
+{
+    std::array<std::uint64_t, BUCKETS> counts;
+    Summary summary;
+    for (std::size_t i = 0; i < BUCKETS; ++i)
+    {
+        counts[i] = now.counts[i] - before.counts[i];
+        summary.count += counts[i];
+    }
+    if (summary.count == 0) return summary;
+
+    summary.mean = static_cast<double>(now.sum - before.sum) / static_cast<double>(summary.count);
+
+    // Highest value a bucket holds: percentiles err on the high side.
+    const std::size_t last = BucketOf(std::numeric_limits<std::uint64_t>::max());
+    const auto high = [&](const std::size_t bucket) {
+        return bucket >= last ? std::numeric_limits<std::uint64_t>::max() : BucketLow(bucket + 1) - 1;
+    };
+    const auto percentile = [&](const double q) {
+        const auto rank = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(summary.count)));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKETS; ++i)
+        {
+            seen += counts[i];
+            if (seen >= rank) return high(i);
+        }
+        return high(last);
+    };
+
+    summary.p50 = percentile(0.50);
+    summary.p90 = percentile(0.90);
+    summary.p99 = percentile(0.99);
+    summary.max = percentile(1.0);
+    return summary;
+}
+
+void MetricsText::Name(const std::string_view name, const std::string_view labels, const std::string_view extraLabel)
+{
+    text += name;
+    if (labels.empty() && extraLabel.empty()) return;
+
+    text += '{';
+    text += labels;
+    if (!labels.empty() && !extraLabel.empty()) text += ',';
+    text += extraLabel;
+    text += '}';
+}
+
+void MetricsText::Add(const std::string_view name, const std::string_view labels, const double value)
+{
+    char number[32];
+    std::snprintf(number, sizeof(number), " %.6g\n", value);
+    Name(name, labels);
+    text += number;
+}
+
+void MetricsText::AddInteger(const std::string_view name, const std::string_view labels, const std::uint64_t value)
+{
+    char number[32];
+    std::snprintf(number, sizeof(number), " %llu\n", static_cast<unsigned long long>(value));
+    Name(name, labels);
+    text += number;
+}
+
+void MetricsText::Add(const std::string_view name, const std::string_view labels, const Histogram::Summary& summary)
+{
+    const std::string base(name);
+    Add(base + "_count", labels, summary.count);
+    Add(base + "_mean", labels, summary.mean);
+
+    const std::pair<const char*, std::uint64_t> quantiles[] = {
+        { "quantile=\"0.5\"", summary.p50 },
+        { "quantile=\"0.9\"", summary.p90 },
+        { "quantile=\"0.99\"", summary.p99 },
+        { "quantile=\"1\"", summary.max },
+    };
+    for (const auto& [label, value] : quantiles)
+    {
+        char number[32];
+        std::snprintf(number, sizeof(number), " %llu\n", static_cast<unsigned long long>(value));
+        Name(name, labels, label);
+        text += number;
+    }
+}
+
+void MetricsText::Comment(const std::string_view line)
+{
+    text += "# ";
+    text += line;
+    text += '\n';
+}
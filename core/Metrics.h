@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Lock-free metric primitives: any thread may update one while another
+// reads it, every operation being a relaxed atomic.
+class Counter
+{
+public:
+    void Add(const std::uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    [[nodiscard]] std::uint64_t Value() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::uint64_t> value{ 0 };
+};
+
+class Gauge
+{
+public:
+    void Set(const std::int64_t v) { value.store(v, std::memory_order_relaxed); }
+    [[nodiscard]] std::int64_t Value() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::int64_t> value{ 0 };
+};
+
+// Distribution of non-negative integer samples (microseconds, bytes, ...)
+// in log-linear buckets: four per power of two, so a percentile read back is
+// within 12.5% of the true value. Recording is one atomic increment; readers
+// take a Snapshot and summarize it, or the difference between two of them
+// to see only the samples recorded in between.
+class Histogram
+{
+public:
+    static constexpr std::size_t BUCKETS = 256;
+
+    struct Snapshot
+    {
+        std::array<std::uint64_t, BUCKETS> counts{};
+        std::uint64_t sum = 0;
+    };
+
+    struct Summary
+    {
+        std::uint64_t count = 0;
+        double mean = 0.0;
+        std::uint64_t p50 = 0;
+        std::uint64_t p90 = 0;
+        std::uint64_t p99 = 0;
+        std::uint64_t max = 0;
+    };
+
+    void Record(std::uint64_t value);
+
+    [[nodiscard]] Snapshot Take() const;
+
+    // Samples in `now` but not in `before`, an earlier snapshot of the same
+    // histogram; an empty Snapshot gives everything since startup.
+    [[nodiscard]] static Summary Summarize(const Snapshot& now, const Snapshot& before);
+
+private:
+    [[nodiscard]] static std::size_t BucketOf(std::uint64_t value);
+    [[nodiscard]] static std::uint64_t BucketLow(std::size_t bucket);
+
+    std::array<std::atomic<std::uint64_t>, BUCKETS> counts{};
+    std::atomic<std::uint64_t> sum{ 0 };
+};
+
+// Builds a report in the Prometheus text format, one sample per line:
+//   war_room_tick_us{room="0",quantile="0.99"} 812
+// so it reads fine in a terminal and any scraper can ingest it.
+class MetricsText
+{
+public:
+    // `labels` is the inside of the braces, e.g. `room="0"`; may be empty.
+    void Add(std::string_view name, std::string_view labels, double value);
+    void Add(const std::string_view name, const std::string_view labels, const std::integral auto value)
+    {
+        AddInteger(name, labels, static_cast<std::uint64_t>(value));
+    }
+
+    // `name`_count, `name`_mean and one `name` line per quantile.
+    void Add(std::string_view name, std::string_view labels, const Histogram::Summary& summary);
+
+    void Comment(std::string_view line);
+
+    [[nodiscard]] const std::string& Str() const { return text; }
+    void Clear() { text.clear(); }
+
+private:
+    void AddInteger(std::string_view name, std::string_view labels, std::uint64_t value);
+    void Name(std::string_view name, std::string_view labels, std::string_view extraLabel = {});
+
+    std::string text;
+};
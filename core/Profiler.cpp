@@ -0,0 +1,213 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+
+// One thread's ring. Only the owner writes it, but EndFrame and export read
+// it from other threads while the owner may be wrapping around, so every
+// slot field is atomic and readers drop what was overwritten mid-copy.
+struct Profiler::ThreadBuffer
+{
+    struct Slot
+    {
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<std::uint64_t> startNs{ 0 };
+        std::atomic<std::uint64_t> endNs{ 0 };
+        std::atomic<std::uint32_t> depth{ 0 };
+    };
+
+    explicit ThreadBuffer(const std::uint32_t threadId)
+        : threadId(threadId), slots(RING_CAPACITY) {}
+
+    // Copies the events from `from` up to the head into `out`, minus any the
+    // owner overwrote during the copy, and returns the head read.
+    std::uint64_t Read(std::uint64_t from, std::vector<Event>& out) const;
+
+    std::uint32_t threadId;
+    std::uint32_t depth = 0;
+    std::vector<Slot> slots;
+
+    // Written only by the owning thread; EndFrame and export read up to it.
+    std::atomic<std::uint64_t> head{ 0 };
+    std::uint64_t consumed = 0;
+};
+
+std::uint64_t Profiler::ThreadBuffer::Read(std::uint64_t from, std::vector<Event>& out) const
+{
+    out.clear();
+
+    const std::uint64_t end = head.load(std::memory_order_acquire);
+    from = std::max(from, end > RING_CAPACITY ? end - RING_CAPACITY : 0);
+    for (std::uint64_t i = from; i < end; ++i)
+    {
+        const Slot& slot = slots[i % RING_CAPACITY];
+        out.push_back({ slot.name.load(std::memory_order_relaxed), slot.startNs.load(std::memory_order_relaxed),
+                        slot.endNs.load(std::memory_order_relaxed), threadId,
+                        slot.depth.load(std::memory_order_relaxed) });
+    }
+
+    // Pairs with the fence in Record: if the copy saw any part of the write
+    // of event n, the head read here is at least n. That write replaces
+    // event n - RING_CAPACITY, so everything up to there may be torn.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const std::uint64_t now = head.load(std::memory_order_relaxed);
+    const std::uint64_t intact = now >= RING_CAPACITY ? now - RING_CAPACITY + 1 : 0;
+    if (intact > from)
+    {
+        out.erase(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(std::min<std::uint64_t>(intact - from, out.size())));
+    }
+    return end;
+}
+
+Profiler& Profiler::Get()
+{
+    static Profiler instance;
+    return instance;
+}
+
+std::uint64_t Profiler::NowNs()
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+Profiler::ThreadBuffer& Profiler::LocalBuffer()
+{
+    thread_local ThreadBuffer* local = nullptr;
+    if (!local)
+    {
+        std::lock_guard lock(mutex);
+        buffers.push_back(std::make_unique<ThreadBuffer>(static_cast<std::uint32_t>(buffers.size())));
+        local = buffers.back().get();
+    }
+    return *local;
+}
+
+std::uint32_t& Profiler::ThreadDepth()
+{
+    return LocalBuffer().depth;
+}
+
+void Profiler::Record(const char* name, const std::uint64_t startNs, const std::uint64_t endNs, const std::uint32_t depth)
+{
+    ThreadBuffer& buffer = LocalBuffer();
+    const std::uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    ThreadBuffer::Slot& slot = buffer.slots[head % RING_CAPACITY];
+    // Orders the previous head store before this slot's stores; see Read.
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.startNs.store(startNs, std::memory_order_relaxed);
+    slot.endNs.store(endNs, std::memory_order_relaxed);
+    slot.depth.store(depth, std::memory_order_relaxed);
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::EndFrame()
+{
+    static const char* const FRAME_ZONE = "Frame";
+
+    const std::uint64_t now = NowNs();
+
+    std::lock_guard lock(mutex);
+
+    const auto zoneFor = [this](const char* name) -> Zone& {
+        auto [it, inserted] = zones.try_emplace(name);
+        if (inserted) it->second.order = static_cast<std::uint32_t>(zones.size() - 1);
+        return it->second;
+    };
+
+    if (frameStartNs != 0)
+    {
+        zoneFor(FRAME_ZONE).currentNs = now - frameStartNs;
+    }
+    frameStartNs = now;
+
+    for (const auto& buffer : buffers)
+    {
+        buffer->consumed = buffer->Read(buffer->consumed, frameEvents);
+        for (const Event& event : frameEvents)
+        {
+            Zone& zone = zoneFor(event.name);
+            zone.depth = event.depth + 1;
+            zone.currentNs += event.endNs - event.startNs;
+        }
+    }
+
+    const std::size_t slot = frameCount % HISTORY_FRAMES;
+    for (auto& [name, zone] : zones)
+    {
+        zone.history[slot] = zone.currentNs;
+        zone.currentNs = 0;
+    }
+    ++frameCount;
+}
+
+std::vector<Profiler::ZoneStats> Profiler::Stats() const
+{
+    std::lock_guard lock(mutex);
+
+    const std::size_t frames = std::min(frameCount, HISTORY_FRAMES);
+    std::vector<ZoneStats> stats(zones.size());
+    if (frames == 0) return {};
+
+    std::vector<std::uint64_t> samples;
+    for (const auto& [name, zone] : zones)
+    {
+        samples.assign(zone.history.begin(), zone.history.begin() + static_cast<std::ptrdiff_t>(frames));
+        std::sort(samples.begin(), samples.end());
+
+        double sum = 0.0;
+        for (const std::uint64_t s : samples) sum += static_cast<double>(s);
+
+        const auto percentile = [&samples](const double p) {
+            const auto index = static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1) + 0.5);
+            return static_cast<double>(samples[index]) * 1e-6;
+        };
+
+        stats[zone.order] = {
+            name, zone.depth,
+            sum / static_cast<double>(frames) * 1e-6,
+            percentile(0.50), percentile(0.95), percentile(0.99),
+            static_cast<double>(samples.back()) * 1e-6
+        };
+    }
+    return stats;
+}
+
+bool Profiler::ExportChromeTrace(const std::string& path) const
+{
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) return false;
+
+    std::lock_guard lock(mutex);
+
+    std::vector<std::vector<Event>> events(buffers.size());
+    std::uint64_t origin = UINT64_MAX;
+    for (std::size_t b = 0; b < buffers.size(); ++b)
+    {
+        buffers[b]->Read(0, events[b]);
+        for (const Event& event : events[b])
+        {
+            origin = std::min(origin, event.startNs);
+        }
+    }
+
+    std::fputs("{\"traceEvents\":[\n", file);
+    bool first = true;
+    for (const auto& list : events)
+    {
+        for (const Event& event : list)
+        {
+            std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",\n", event.name, event.threadId,
+                static_cast<double>(event.startNs - origin) * 1e-3,
+                static_cast<double>(event.endNs - event.startNs) * 1e-3);
+            first = false;
+        }
+    }
+    std::fputs("\n]}\n", file);
+
+    return std::fclose(file) == 0;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Hierarchical CPU profiler. PROFILE_SCOPE records a timed zone into a
+// per-thread ring buffer with a few relaxed stores; EndFrame folds the new
+// events into per-zone frame totals kept for the last HISTORY_FRAMES frames.
+// Build with WAR_PROFILER_ENABLED undefined and every macro disappears.
+class Profiler
+{
+public:
+    struct Event
+    {
+        const char* name;
+        std::uint64_t startNs;
+        std::uint64_t endNs;
+        std::uint32_t threadId;
+        std::uint32_t depth;
+    };
+
+    struct ZoneStats
+    {
+        const char* name;
+        std::uint32_t depth;
+        double avgMs;
+        double p50Ms;
+        double p95Ms;
+        double p99Ms;
+        double maxMs;
+    };
+
+    static Profiler& Get();
+
+    [[nodiscard]] static std::uint64_t NowNs();
+
+    void Record(const char* name, std::uint64_t startNs, std::uint64_t endNs, std::uint32_t depth);
+    [[nodiscard]] std::uint32_t& ThreadDepth();
+
+    void EndFrame();
+
+    // Per-zone statistics over the recorded frame history, in first-seen order.
+    [[nodiscard]] std::vector<ZoneStats> Stats() const;
+
+    // Writes every event still held in the ring buffers as Chrome trace JSON
+    // (chrome://tracing, Perfetto).
+    bool ExportChromeTrace(const std::string& path) const;
+
+    static constexpr std::size_t RING_CAPACITY = 1 << 15;
+    static constexpr std::size_t HISTORY_FRAMES = 240;
+
+private:
+    struct ThreadBuffer;
+    struct Zone
+    {
+        std::uint32_t order = 0;
+        std::uint32_t depth = 0;
+        std::uint64_t currentNs = 0;
+        std::vector<std::uint64_t> history = std::vector<std::uint64_t>(HISTORY_FRAMES, 0);
+    };
+
+    Profiler() = default;
+
+    ThreadBuffer& LocalBuffer();
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::unordered_map<const char*, Zone> zones;
+    // EndFrame's copy of one ring, kept to reuse its storage.
+    std::vector<Event> frameEvents;
+    std::uint64_t frameStartNs = 0;
+    std::size_t frameCount = 0;
+};
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name)
+        : name(name), depth(Profiler::Get().ThreadDepth()++), startNs(Profiler::NowNs()) {}
+
+    ~ProfileScope()
+    {
+        Profiler& profiler = Profiler::Get();
+        profiler.Record(name, startNs, Profiler::NowNs(), depth);
+        --profiler.ThreadDepth();
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    std::uint32_t depth;
+    std::uint64_t startNs;
+};
+
+#if defined(WAR_PROFILER_ENABLED)
+    #define WAR_PROFILE_CONCAT_INNER(a, b) a##b
+    #define WAR_PROFILE_CONCAT(a, b) WAR_PROFILE_CONCAT_INNER(a, b)
+    #define PROFILE_SCOPE(name) ProfileScope WAR_PROFILE_CONCAT(profileScope_, __LINE__)(name)
+    #define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+    #define PROFILE_FRAME_END() Profiler::Get().EndFrame()
+#else
+    #define PROFILE_SCOPE(name) ((void)0)
+    #define PROFILE_FUNCTION() ((void)0)
+    #define PROFILE_FRAME_END() ((void)0)
+#endif
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+// Bounded wait-free queue for exactly one producer thread and one consumer
+// thread. The read and write indices sit on their own cache lines and each side keeps a
+// cached copy of the other's index, so the shared lines are only touched
+// when the queue looks full (producer) or empty (consumer).
+template <typename T, std::size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side. Returns false, leaving `value` untouched, when full.
+    bool TryPush(T&& value)
+    {
+        const std::size_t tail = writeIndex.load(std::memory_order_relaxed);
+        if (tail - readCache == Capacity)
+        {
+            readCache = readIndex.load(std::memory_order_acquire);
+            if (tail - readCache == Capacity)
+            {
+                return false;
+            }
+        }
+
+        slots[tail & MASK] = std::move(value);
+        writeIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPush(const T& value)
+    {
+        T copy = value;
+        return TryPush(std::move(copy));
+    }
+
+    // Consumer side.
+    std::optional<T> TryPop()
+    {
+        const std::size_t head = readIndex.load(std::memory_order_relaxed);
+        if (head == writeCache)
+        {
+            writeCache = writeIndex.load(std::memory_order_acquire);
+            if (head == writeCache)
+            {
+                return std::nullopt;
+            }
+        }
+
+        std::optional<T> value(std::move(slots[head & MASK]));
+        readIndex.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+    // Approximate when called while the other side is running.
+    [[nodiscard]] std::size_t SizeApprox() const
+    {
+        return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+    }
+
+    static constexpr std::size_t CAPACITY = Capacity;
+
+private:
+    static constexpr std::size_t MASK = Capacity - 1;
+    static constexpr std::size_t LINE = 64;
+
+    alignas(LINE) std::atomic<std::size_t> readIndex{ 0 };
+    std::size_t writeCache = 0;
+
+    alignas(LINE) std::atomic<std::size_t> writeIndex{ 0 };
+    std::size_t readCache = 0;
+
+    alignas(LINE) std::array<T, Capacity> slots{};
+};
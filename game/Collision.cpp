@@ -0,0 +1,90 @@
+#include "Collision.h"
+#include "raylib.h"
+
+#include <cmath>
+
+Rectangle SweepBounds(const Vector2 from, const Vector2 to, const float radius)
+{
+    const float minX = fminf(from.x, to.x) - radius;
+    const float minY = fminf(from.y, to.y) - radius;
+    const float maxX = fmaxf(from.x, to.x) + radius;
+    const float maxY = fmaxf(from.y, to.y) + radius;
+    return { minX, minY, maxX - minX, maxY - minY };
+}
+
+static float SegmentCircleT(const Vector2 from, const Vector2 d, const Vector2 center, const float radius)
+{
+    const float fx = from.x - center.x;
+    const float fy = from.y - center.y;
+
+    const float a = d.x * d.x + d.y * d.y;
+    const float b = fx * d.x + fy * d.y;
+    const float c = fx * fx + fy * fy - radius * radius;
+
+    if (c <= 0.0f) return 0.0f;
+    if (a < 1e-12f || b > 0.0f) return -1.0f;
+
+    const float disc = b * b - a * c;
+    if (disc < 0.0f) return -1.0f;
+
+    const float t = (-b - sqrtf(disc)) / a;
+    return t <= 1.0f ? t : -1.0f;
+}
+
+float SweepCircleRect(const Vector2 from, const Vector2 to, const float radius, const Rectangle &rect)
+{
+    const float minX = rect.x - radius;
+    const float minY = rect.y - radius;
+    const float maxX = rect.x + rect.width + radius;
+    const float maxY = rect.y + rect.height + radius;
+
+    const Vector2 d = { to.x - from.x, to.y - from.y };
+
+    float tEnter = 0.0f;
+    float tExit  = 1.0f;
+
+    const float origin[2] = { from.x, from.y };
+    const float dir[2]    = { d.x, d.y };
+    const float lo[2]     = { minX, minY };
+    const float hi[2]     = { maxX, maxY };
+
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        if (fabsf(dir[axis]) < 1e-8f)
+        {
+            if (origin[axis] < lo[axis] || origin[axis] > hi[axis]) return -1.0f;
+            continue;
+        }
+
+        const float inv = 1.0f / dir[axis];
+        float t0 = (lo[axis] - origin[axis]) * inv;
+        float t1 = (hi[axis] - origin[axis]) * inv;
+        if (t0 > t1)
+        {
+            const float tmp = t0;
+            t0 = t1;
+            t1 = tmp;
+        }
+
+        tEnter = fmaxf(tEnter, t0);
+        tExit  = fminf(tExit, t1);
+        if (tEnter > tExit) return -1.0f;
+    }
+
+    // The expanded box over-approximates the rounded corners: when the entry
+    // point lies beyond the original rect on both axes, test the corner circle.
+    const float px = from.x + d.x * tEnter;
+    const float py = from.y + d.y * tEnter;
+
+    float cornerX;
+    float cornerY;
+    if (px < rect.x) cornerX = rect.x;
+    else if (px > rect.x + rect.width) cornerX = rect.x + rect.width;
+    else return tEnter;
+
+    if (py < rect.y) cornerY = rect.y;
+    else if (py > rect.y + rect.height) cornerY = rect.y + rect.height;
+    else return tEnter;
+
+    return SegmentCircleT(from, d, Vector2{ cornerX, cornerY }, radius);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "raylib.h"
+
+// Bounding box of a circle of `radius` swept from `from` to `to`; used as the
+// broadphase for SweepCircleRect.
+[[nodiscard]] Rectangle SweepBounds(Vector2 from, Vector2 to, float radius);
+
+// Time of impact in [0, 1] of a circle moving from `from` to `to` against
+// `rect`, or -1 when the swept circle never touches it. Starting in contact
+// reports 0. Corners are treated exactly (rounded Minkowski sum).
+[[nodiscard]] float SweepCircleRect(Vector2 from, Vector2 to, float radius, const Rectangle &rect);
@@ -0,0 +1,374 @@
+#include "EnvIndex.h"
+#include "Collision.h"
+#include "raylib.h"
+
+#include <algorithm>
+#include <cmath>
+
+static float RaySegmentT(const Vector2 O, const Vector2 D,
+                          const Vector2 A, const Vector2 B,
+                          const float maxT)
+{
+    const float ex = B.x - A.x, ey = B.y - A.y;
+    const float denom = D.x * ey - D.y * ex;
+    if (fabsf(denom) < 1e-6f) return -1.0f;
+
+    const float fx = A.x - O.x, fy = A.y - O.y;
+    const float t  = (fx * ey - fy * ex) / denom;
+    const float s  = (fx * D.y - fy * D.x) / denom;
+
+    if (t < 0.0f || t > maxT || s < 0.0f || s > 1.0f) return -1.0f;
+    return t;
+}
+
+static float RayRectEdgesT(const Vector2 origin, const Vector2 dir, const Rectangle& rect, float minT)
+{
+    const Vector2 corners[4] = {
+        { rect.x,              rect.y               },
+        { rect.x + rect.width, rect.y               },
+        { rect.x + rect.width, rect.y + rect.height },
+        { rect.x,              rect.y + rect.height }
+    };
+    for (int e = 0; e < 4; ++e)
+    {
+        const float t = RaySegmentT(origin, dir, corners[e], corners[(e + 1) % 4], minT);
+        if (t >= 0.0f && t < minT) minT = t;
+    }
+    return minT;
+}
+
+// Entry distance of the ray into `box` clipped to [0, maxT], or -1 on a miss.
+static float RayBoxEnter(const Vector2 origin, const Vector2 dir, const Rectangle& box, const float maxT)
+{
+    float tEnter = 0.0f;
+    float tExit  = maxT;
+
+    const float o[2]  = { origin.x, origin.y };
+    const float d[2]  = { dir.x, dir.y };
+    const float lo[2] = { box.x, box.y };
+    const float hi[2] = { box.x + box.width, box.y + box.height };
+
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        if (fabsf(d[axis]) < 1e-8f)
+        {
+            if (o[axis] < lo[axis] || o[axis] > hi[axis]) return -1.0f;
+            continue;
+        }
+
+        const float inv = 1.0f / d[axis];
+        float t0 = (lo[axis] - o[axis]) * inv;
+        float t1 = (hi[axis] - o[axis]) * inv;
+        if (t0 > t1) std::swap(t0, t1);
+
+        tEnter = fmaxf(tEnter, t0);
+        tExit  = fminf(tExit, t1);
+        if (tEnter > tExit) return -1.0f;
+    }
+    return tEnter;
+}
+
+static Rectangle Union(const Rectangle& a, const Rectangle& b)
+{
+    const float minX = fminf(a.x, b.x);
+    const float minY = fminf(a.y, b.y);
+    const float maxX = fmaxf(a.x + a.width, b.x + b.width);
+    const float maxY = fmaxf(a.y + a.height, b.y + b.height);
+    return { minX, minY, maxX - minX, maxY - minY };
+}
+
+void EnvIndex::Build(const std::vector<EnvItem>& envItems, const Mode buildMode, const float gridCellSize)
+{
+    mode  = buildMode;
+    items = envItems;
+
+    solid.clear();
+    solidRects.clear();
+    for (int i = 0; i < static_cast<int>(items.size()); ++i)
+    {
+        if (!items[i].blocking) continue;
+        solid.push_back(i);
+        solidRects.push_back(items[i].rect);
+    }
+
+    bounds = {};
+    for (std::size_t k = 0; k < solidRects.size(); ++k)
+    {
+        bounds = k == 0 ? solidRects[k] : Union(bounds, solidRects[k]);
+    }
+
+    cellStart.clear();
+    cellItems.clear();
+    firstCellX.clear();
+    firstCellY.clear();
+    nodes.clear();
+    nodeItems.clear();
+    cols = rows = 0;
+
+    if (solid.empty()) return;
+
+    if (mode == Mode::Grid)
+    {
+        BuildGrid(gridCellSize);
+    }
+    else
+    {
+        nodeItems.resize(solid.size());
+        for (int k = 0; k < static_cast<int>(solid.size()); ++k) nodeItems[k] = k;
+        BuildNode(0, static_cast<int>(solid.size()));
+    }
+}
+
+void EnvIndex::BuildGrid(const float gridCellSize)
+{
+    cellSize    = gridCellSize > 1.0f ? gridCellSize : 1.0f;
+    invCellSize = 1.0f / cellSize;
+    cols = std::max(1, static_cast<int>(ceilf(bounds.width  * invCellSize)));
+    rows = std::max(1, static_cast<int>(ceilf(bounds.height * invCellSize)));
+
+    const auto cellX = [this](const float x) {
+        return std::clamp(static_cast<int>(floorf((x - bounds.x) * invCellSize)), 0, cols - 1);
+    };
+    const auto cellY = [this](const float y) {
+        return std::clamp(static_cast<int>(floorf((y - bounds.y) * invCellSize)), 0, rows - 1);
+    };
+
+    const int itemCount = static_cast<int>(solidRects.size());
+    firstCellX.resize(itemCount);
+    firstCellY.resize(itemCount);
+
+    // Counting pass, then fill, so the cell lists live in one flat array.
+    cellStart.assign(cols * rows + 1, 0);
+    for (int k = 0; k < itemCount; ++k)
+    {
+        const Rectangle& r = solidRects[k];
+        firstCellX[k] = cellX(r.x);
+        firstCellY[k] = cellY(r.y);
+        for (int cy = firstCellY[k]; cy <= cellY(r.y + r.height); ++cy)
+            for (int cx = firstCellX[k]; cx <= cellX(r.x + r.width); ++cx)
+                ++cellStart[cy * cols + cx + 1];
+    }
+    for (int c = 0; c < cols * rows; ++c)
+    {
+        cellStart[c + 1] += cellStart[c];
+    }
+
+    cellItems.resize(cellStart.back());
+    std::vector<int> cursor(cellStart.begin(), cellStart.end() - 1);
+    for (int k = 0; k < itemCount; ++k)
+    {
+        const Rectangle& r = solidRects[k];
+        for (int cy = firstCellY[k]; cy <= cellY(r.y + r.height); ++cy)
+            for (int cx = firstCellX[k]; cx <= cellX(r.x + r.width); ++cx)
+                cellItems[cursor[cy * cols + cx]++] = k;
+    }
+}
+
+int EnvIndex::BuildNode(const int first, const int count)
+{
+    constexpr int LEAF_SIZE = 4;
+
+    Rectangle box = solidRects[nodeItems[first]];
+    for (int i = first + 1; i < first + count; ++i)
+    {
+        box = Union(box, solidRects[nodeItems[i]]);
+    }
+
+    const int index = static_cast<int>(nodes.size());
+    nodes.push_back({ box, -1, -1, first, count });
+    if (count <= LEAF_SIZE) return index;
+
+    // Median split on the longer axis by item centre.
+    const bool splitX = box.width >= box.height;
+    const int mid = first + count / 2;
+    std::nth_element(nodeItems.begin() + first, nodeItems.begin() + mid, nodeItems.begin() + first + count,
+        [this, splitX](const int a, const int b) {
+            const Rectangle& ra = solidRects[a];
+            const Rectangle& rb = solidRects[b];
+            return splitX ? ra.x + ra.width * 0.5f < rb.x + rb.width * 0.5f
+                          : ra.y + ra.height * 0.5f < rb.y + rb.height * 0.5f;
+        });
+
+    const int left  = BuildNode(first, mid - first);
+    const int right = BuildNode(mid, first + count - mid);
+    nodes[index].left  = left;
+    nodes[index].right = right;
+    nodes[index].count = 0;
+    return index;
+}
+
+void EnvIndex::QueryRect(const Rectangle& area, std::vector<int>& out) const
+{
+    out.clear();
+    if (solid.empty() || !CheckCollisionRecs(area, bounds)) return;
+
+    if (mode == Mode::Grid) QueryGrid(area, out);
+    else QueryBVH(area, out);
+
+    std::sort(out.begin(), out.end());
+}
+
+void EnvIndex::QueryGrid(const Rectangle& area, std::vector<int>& out) const
+{
+    const int x0 = std::clamp(static_cast<int>(floorf((area.x - bounds.x) * invCellSize)), 0, cols - 1);
+    const int y0 = std::clamp(static_cast<int>(floorf((area.y - bounds.y) * invCellSize)), 0, rows - 1);
+    const int x1 = std::clamp(static_cast<int>(floorf((area.x + area.width  - bounds.x) * invCellSize)), 0, cols - 1);
+    const int y1 = std::clamp(static_cast<int>(floorf((area.y + area.height - bounds.y) * invCellSize)), 0, rows - 1);
+
+    for (int cy = y0; cy <= y1; ++cy)
+    {
+        for (int cx = x0; cx <= x1; ++cx)
+        {
+            const int cell = cy * cols + cx;
+            for (int c = cellStart[cell]; c < cellStart[cell + 1]; ++c)
+            {
+                const int k = cellItems[c];
+                // Report an item only from the first cell it shares with the
+                // query, so large items are not returned once per cell.
+                if (cx != std::max(firstCellX[k], x0) || cy != std::max(firstCellY[k], y0)) continue;
+                if (CheckCollisionRecs(area, solidRects[k])) out.push_back(solid[k]);
+            }
+        }
+    }
+}
+
+void EnvIndex::QueryBVH(const Rectangle& area, std::vector<int>& out) const
+{
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0)
+    {
+        const Node& node = nodes[stack[--top]];
+        if (!CheckCollisionRecs(area, node.bounds)) continue;
+
+        if (node.left < 0)
+        {
+            for (int i = node.first; i < node.first + node.count; ++i)
+            {
+                const int k = nodeItems[i];
+                if (CheckCollisionRecs(area, solidRects[k])) out.push_back(solid[k]);
+            }
+            continue;
+        }
+
+        stack[top++] = node.left;
+        stack[top++] = node.right;
+    }
+}
+
+void EnvIndex::QueryCircle(const Vector2 center, const float radius, std::vector<int>& out) const
+{
+    QueryRect({ center.x - radius, center.y - radius, radius * 2.0f, radius * 2.0f }, out);
+    out.erase(std::remove_if(out.begin(), out.end(), [&](const int i) {
+        return !CheckCollisionCircleRec(center, radius, items[i].rect);
+    }), out.end());
+}
+
+bool EnvIndex::IsPointBlocked(const Vector2 point) const
+{
+    static thread_local std::vector<int> candidates;
+    QueryRect({ point.x - 0.5f, point.y - 0.5f, 1.0f, 1.0f }, candidates);
+    for (const int i : candidates)
+    {
+        if (CheckCollisionPointRec(point, items[i].rect)) return true;
+    }
+    return false;
+}
+
+float EnvIndex::CastRay(const Vector2 origin, const Vector2 dir, const float maxDist) const
+{
+    if (solid.empty()) return maxDist;
+    return mode == Mode::Grid ? CastRayGrid(origin, dir, maxDist) : CastRayBVH(origin, dir, maxDist);
+}
+
+float EnvIndex::CastRayGrid(const Vector2 origin, const Vector2 dir, const float maxDist) const
+{
+    const float tStart = RayBoxEnter(origin, dir, bounds, maxDist);
+    if (tStart < 0.0f) return maxDist;
+
+    const float px = origin.x + dir.x * tStart;
+    const float py = origin.y + dir.y * tStart;
+    int cx = std::clamp(static_cast<int>(floorf((px - bounds.x) * invCellSize)), 0, cols - 1);
+    int cy = std::clamp(static_cast<int>(floorf((py - bounds.y) * invCellSize)), 0, rows - 1);
+
+    const int stepX = dir.x > 0.0f ? 1 : -1;
+    const int stepY = dir.y > 0.0f ? 1 : -1;
+    const float tDeltaX = fabsf(dir.x) > 1e-8f ? cellSize / fabsf(dir.x) : INFINITY;
+    const float tDeltaY = fabsf(dir.y) > 1e-8f ? cellSize / fabsf(dir.y) : INFINITY;
+    float tNextX = fabsf(dir.x) > 1e-8f
+        ? (bounds.x + static_cast<float>(cx + (stepX > 0 ? 1 : 0)) * cellSize - origin.x) / dir.x
+        : INFINITY;
+    float tNextY = fabsf(dir.y) > 1e-8f
+        ? (bounds.y + static_cast<float>(cy + (stepY > 0 ? 1 : 0)) * cellSize - origin.y) / dir.y
+        : INFINITY;
+
+    float minT = maxDist;
+    while (true)
+    {
+        const int cell = cy * cols + cx;
+        for (int c = cellStart[cell]; c < cellStart[cell + 1]; ++c)
+        {
+            minT = RayRectEdgesT(origin, dir, solidRects[cellItems[c]], minT);
+        }
+
+        const float cellExit = fminf(tNextX, tNextY);
+        if (minT <= cellExit || cellExit >= maxDist) break;
+
+        if (tNextX < tNextY)
+        {
+            cx += stepX;
+            tNextX += tDeltaX;
+            if (cx < 0 || cx >= cols) break;
+        }
+        else
+        {
+            cy += stepY;
+            tNextY += tDeltaY;
+            if (cy < 0 || cy >= rows) break;
+        }
+    }
+    return minT;
+}
+
+float EnvIndex::CastRayBVH(const Vector2 origin, const Vector2 dir, const float maxDist) const
+{
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+
+    float minT = maxDist;
+    while (top > 0)
+    {
+        const Node& node = nodes[stack[--top]];
+        if (RayBoxEnter(origin, dir, node.bounds, minT) < 0.0f) continue;
+
+        if (node.left < 0)
+        {
+            for (int i = node.first; i < node.first + node.count; ++i)
+            {
+                minT = RayRectEdgesT(origin, dir, solidRects[nodeItems[i]], minT);
+            }
+            continue;
+        }
+
+        stack[top++] = node.left;
+        stack[top++] = node.right;
+    }
+    return minT;
+}
+
+float EnvIndex::SweepCircle(const Vector2 from, const Vector2 to, const float radius) const
+{
+    static thread_local std::vector<int> candidates;
+    QueryRect(SweepBounds(from, to, radius), candidates);
+
+    float firstT = -1.0f;
+    for (const int i : candidates)
+    {
+        const float t = SweepCircleRect(from, to, radius, items[i].rect);
+        if (t >= 0.0f && (firstT < 0.0f || t < firstT)) firstT = t;
+    }
+    return firstT;
+}
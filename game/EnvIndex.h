@@ -0,0 +1,77 @@
+#pragma once
+
+#include "raylib.h"
+#include <vector>
+
+struct EnvItem {
+    Rectangle rect;
+    int blocking;
+    Color color;
+};
+
+// Static acceleration structure over the blocking EnvItems of a level, built
+// once by Game and shared by player/bot physics, bullets and AI ray casts.
+// Query results are indices into the item list passed to Build, ascending.
+class EnvIndex
+{
+public:
+    enum class Mode { Grid, BVH };
+
+    EnvIndex() = default;
+
+    void Build(const std::vector<EnvItem>& items, Mode mode = Mode::Grid, float cellSize = 128.0f);
+
+    [[nodiscard]] Mode GetMode() const { return mode; }
+    [[nodiscard]] const std::vector<EnvItem>& Items() const { return items; }
+    [[nodiscard]] const EnvItem& Item(const int index) const { return items[index]; }
+
+    void QueryRect(const Rectangle& area, std::vector<int>& out) const;
+    void QueryCircle(Vector2 center, float radius, std::vector<int>& out) const;
+    [[nodiscard]] bool IsPointBlocked(Vector2 point) const;
+
+    // Distance along the unit direction `dir` to the first blocking edge, or
+    // maxDist when nothing is hit.
+    [[nodiscard]] float CastRay(Vector2 origin, Vector2 dir, float maxDist) const;
+
+    // Earliest time of impact in [0, 1] of a circle swept from `from` to `to`,
+    // or -1 when it reaches `to` unobstructed.
+    [[nodiscard]] float SweepCircle(Vector2 from, Vector2 to, float radius) const;
+
+private:
+    struct Node
+    {
+        Rectangle bounds;
+        int left;
+        int right;
+        int first;
+        int count;
+    };
+
+    void BuildGrid(float cellSize);
+    int BuildNode(int first, int count);
+
+    void QueryGrid(const Rectangle& area, std::vector<int>& out) const;
+    void QueryBVH(const Rectangle& area, std::vector<int>& out) const;
+    [[nodiscard]] float CastRayGrid(Vector2 origin, Vector2 dir, float maxDist) const;
+    [[nodiscard]] float CastRayBVH(Vector2 origin, Vector2 dir, float maxDist) const;
+
+    Mode mode = Mode::Grid;
+    std::vector<EnvItem> items;
+
+    // Blocking items only; `solid[k]` indexes into `items`.
+    std::vector<int> solid;
+    std::vector<Rectangle> solidRects;
+    Rectangle bounds{};
+
+    float cellSize = 128.0f;
+    float invCellSize = 1.0f / 128.0f;
+    int cols = 0;
+    int rows = 0;
+    std::vector<int> cellStart;
+    std::vector<int> cellItems;
+    std::vector<int> firstCellX;
+    std::vector<int> firstCellY;
+
+    std::vector<Node> nodes;
+    std::vector<int> nodeItems;
+};
@@ -0,0 +1,26 @@
+#include "FixedTimestep.h"
+
+FixedTimestep::FixedTimestep(const float tickRate, const int maxStepsPerFrame)
+    : step(1.0f / (tickRate > 1.0f ? tickRate : 1.0f)), maxStepsPerFrame(maxStepsPerFrame) {}
+
+void FixedTimestep::SetTickRate(const float tickRate)
+{
+    step = 1.0f / (tickRate > 1.0f ? tickRate : 1.0f);
+    accumulator = 0.0;
+}
+
+int FixedTimestep::Advance(const float frameTime)
+{
+    accumulator += frameTime > 0.0f ? frameTime : 0.0f;
+
+    int steps = static_cast<int>(accumulator / step);
+    if (steps > maxStepsPerFrame)
+    {
+        steps = maxStepsPerFrame;
+        accumulator = 0.0;
+        return steps;
+    }
+
+    accumulator -= static_cast<double>(steps) * step;
+    return steps;
+}
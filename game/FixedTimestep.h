@@ -0,0 +1,27 @@
+#pragma once
+
+// Accumulates real frame time and hands out whole simulation ticks of a fixed
+// length. Time beyond `maxStepsPerFrame` ticks is dropped so a hitch slows
+// the game down briefly instead of triggering a catch-up spiral.
+class FixedTimestep
+{
+public:
+    explicit FixedTimestep(float tickRate = 60.0f, int maxStepsPerFrame = 5);
+
+    void SetTickRate(float tickRate);
+
+    // Adds `frameTime` seconds and returns how many ticks to simulate now.
+    int Advance(float frameTime);
+
+    [[nodiscard]] float Step() const { return step; }
+    [[nodiscard]] float TickRate() const { return 1.0f / step; }
+
+    // Fraction of a tick left in the accumulator, for blending render state
+    // between the previous and the current tick.
+    [[nodiscard]] float Alpha() const { return static_cast<float>(accumulator / step); }
+
+private:
+    double accumulator = 0.0;
+    float step;
+    int maxStepsPerFrame;
+};
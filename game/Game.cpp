@@ -1,14 +1,15 @@
 #include "Game.h"
 #include "raylib.h"
 #include "raymath.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "Protocol.h"
 
+#include <algorithm>
 #include <cmath>
-#include <sstream>
-#include <cstdlib>
-#include <ctime>
 
 static void UpdateCameraCenter(Camera2D *camera, Player *player,
-    EnvItem *envItems, int envItemsLength,
+    const EnvItem *envItems, int envItemsLength,
     float delta, const float width, const float height)
 {
     camera->offset = Vector2{ width / 2.0f, height / 2.0f };
@@ -16,7 +17,7 @@ static void UpdateCameraCenter(Camera2D *camera, Player *player,
 }
 
 static void UpdateCameraCenterInsideMap(Camera2D *camera, Player *player,
-    EnvItem *envItems, int envItemsLength,
+    const EnvItem *envItems, int envItemsLength,
     float delta, const float width, const float height)
 {
     camera->target = player->position;
@@ -59,7 +60,7 @@ static void UpdateCameraCenterInsideMap(Camera2D *camera, Player *player,
 }
 
 static void UpdateCameraCenterSmoothFollow(Camera2D *camera, Player *player,
-    EnvItem *envItems, int envItemsLength,
+    const EnvItem *envItems, int envItemsLength,
     const float delta, const float width, const float height)
 {
     static float minSpeed = 30;
@@ -77,7 +78,7 @@ static void UpdateCameraCenterSmoothFollow(Camera2D *camera, Player *player,
 }
 
 static void UpdateCameraEvenOutOnLanding(Camera2D *camera, Player *player,
-    EnvItem *envItems, int envItemsLength,
+    const EnvItem *envItems, int envItemsLength,
     const float delta, const float width, const float height)
 {
     static float evenOutSpeed = 700;
@@ -121,7 +122,7 @@ static void UpdateCameraEvenOutOnLanding(Camera2D *camera, Player *player,
 }
 
 static void UpdateCameraPlayerBoundsPush(Camera2D *camera, Player *player,
-    EnvItem *envItems, int envItemsLength,
+    const EnvItem *envItems, int envItemsLength,
     float delta, const float width, const float height)
 {
     static Vector2 bbox = { 0.2f, 0.2f };
@@ -155,8 +156,57 @@ static void UpdateCameraPlayerBoundsPush(Camera2D *camera, Player *player,
     }
 }
 
-Game::Game(const int screenWidth, const int screenHeight)
-    : screenWidth(screenWidth), screenHeight(screenHeight)
+static void DrawProfilerOverlay(const int x, const int y)
+{
+    const auto stats = Profiler::Get().Stats();
+
+    constexpr int lineHeight = 14;
+    const int height = lineHeight * (static_cast<int>(stats.size()) + 2);
+    DrawRectangle(x - 8, y - 6, 460, height + 6, Fade(BLACK, 0.7f));
+
+    DrawText(TextFormat("%-22s %7s %7s %7s %7s %7s", "zone (ms)", "avg", "p50", "p95", "p99", "max"),
+        x, y, 10, RAYWHITE);
+
+    int row = 1;
+    for (const auto& zone : stats)
+    {
+        DrawText(TextFormat("%*s%-*s %7.3f %7.3f %7.3f %7.3f %7.3f",
+                static_cast<int>(zone.depth) * 2, "", 22 - static_cast<int>(zone.depth) * 2, zone.name,
+                zone.avgMs, zone.p50Ms, zone.p95Ms, zone.p99Ms, zone.maxMs),
+            x, y + row * lineHeight, 10, zone.depth == 0 ? YELLOW : RAYWHITE);
+        ++row;
+    }
+}
+
+// Replicated velocities below this are quantization noise around zero, and
+// too slow to move an actor by a position step between snapshots anyway.
+static constexpr float REST_SPEED = 4.0f;
+
+// The server repeats an actor's baseline state when its bandwidth budget
+// defers it, which the delta coding can't tell apart from an actor that
+// hasn't changed. The repeat is stale if the actor is moving (a moving
+// actor always changes) or if a newer state has arrived since the
+// baseline; stamping it with the new tick would freeze the actor, or pull
+// it back, and then snap it forward. Its buffer extrapolates from the last
+// real sample instead.
+template <typename Msg>
+static bool IsStaleRepeat(const Msg& state, const std::vector<Msg>* baseline, const double baseTime,
+                          const InterpolationBuffer& history)
+{
+    if (!baseline)
+    {
+        return false;
+    }
+
+    const Msg* old = findById(*baseline, state.id);
+    const bool repeated = old && old->position.x == state.position.x && old->position.y == state.position.y &&
+                          old->velocity.x == state.velocity.x && old->velocity.y == state.velocity.y;
+    const bool moving = Vector2Length(state.velocity) > REST_SPEED;
+    return repeated && (moving || history.NewestTime() > baseTime);
+}
+
+Game::Game(const int screenWidth, const int screenHeight, const bool headless)
+    : screenWidth(screenWidth), screenHeight(screenHeight), headless(headless)
 {
     InitScene();
 
@@ -168,201 +218,414 @@ Game::Game(const int screenWidth, const int screenHeight)
         UpdateCameraPlayerBoundsPush
     };
 
-    std::srand(static_cast<unsigned>(std::time(nullptr)));
-    clientId = static_cast<uint32_t>(std::rand());
-
-    if (netClient.connectTo("127.0.0.1", 1234))
+    if (headless)
     {
-        netClient.setReceiveCallback([this](const std::vector<uint8_t>& data){
-            const std::string s(data.begin(), data.end());
-            std::istringstream iss(s);
-            std::string cmd;
-            iss >> cmd;
-
-            if (cmd == "POS")
-            {
-                uint32_t id = 0; float x = 0, y = 0;
-                iss >> id >> x >> y;
-
-                if (id != clientId)
-                {
-                    remotePlayers[id] = Vector2{ x, y };
-                }
-            }
-        });
+        return;
     }
+
+    netClient.connectTo("127.0.0.1", 1234);
 }
 
 Game::~Game() = default;
 
-void Game::InitScene()
+void Game::SetTickRate(const float tickRate)
 {
-    player = Player();
-    player.position = Vector2{ 100, 500 };
-    player.speed = 0;
-    player.canJump = false;
-
-    envItems = {
-        EnvItem{ { 0,    0,   2000,   10  },     1, GRAY },
-        EnvItem{ { 0,    0,   10,     700 },     1, GRAY },
-        EnvItem{ { 1990, 0,   10,     700 },     1, GRAY },
-        EnvItem{ { 0,    690, 2000,   10  },     1, GRAY },
-
-        EnvItem{ { 0,   300, 400, 50 } ,1, GRAY },
-        EnvItem{ { 350, 500, 400, 50 } ,1, GRAY },
-        EnvItem{ { 600, 130, 250, 50 } ,1, GRAY },
-
-        EnvItem{ { 1150, 500, 400, 50 } ,1, GRAY },
-        EnvItem{ { 1600, 300, 400, 50 } ,1, GRAY },
-        EnvItem{ { 1050, 160, 300, 50 } ,1, GRAY },
-
-        EnvItem{ { 500,  640, 200, 50 }, 1,  GRAY },
-        EnvItem{ { 1200, 640, 200, 50 }, 1,  GRAY },
+    timestep.SetTickRate(tickRate);
+    scriptedInput = ScriptedInputSource(1, timestep.TickRate());
+}
 
-        EnvItem{ { 850, 10, 200, 350 }, 1, GRAY},
-    };
+void Game::InitScene()
+{
+    world.InitScene();
+    localPlayerId = world.AddPlayer(Vector2{ 100, 500 });
 
     camera = {};
-    camera.target = player.position;
+    camera.target = Vector2{ 100, 500 };
     camera.offset = Vector2{ static_cast<float>(screenWidth) / 2.0f, static_cast<float>(screenHeight) / 2.0f };
     camera.rotation = 0.0f;
     camera.zoom = 1.0f;
+}
 
-    bots.clear();
-    bots.emplace_back(Vector2{ 1800.0f, 500.0f }, 0.2f, 0.3f); 
-    bots.emplace_back(Vector2{ 1200.0f, 400.0f }, 0.6f, 0.7f); 
-    bots.emplace_back(Vector2{  700.0f, 100.0f }, 1.0f, 1.0f); 
+void Game::Simulate(const int ticks)
+{
+    for (int i = 0; i < ticks; ++i)
+    {
+        Tick(timestep.Step());
+    }
 }
 
 void Game::Update(const float delta)
 {
-    player.Update(delta, envItems);
+    PROFILE_SCOPE("Game::Update");
+
+    if (headless)
+    {
+        Simulate(timestep.Advance(delta));
+        return;
+    }
+
+    clientTime += delta;
+    deviceInput.Poll(camera, aim.GetRadius());
+
+#if defined(WAR_PROFILER_ENABLED)
+    if (IsKeyPressed(KEY_F3))
+    {
+        showProfiler = !showProfiler;
+    }
+    if (IsKeyPressed(KEY_F4))
+    {
+        Profiler::Get().ExportChromeTrace("war_trace.json");
+    }
+#endif
+
+    const int steps = timestep.Advance(delta);
+    for (int i = 0; i < steps; ++i)
+    {
+        Tick(timestep.Step());
+    }
+    UpdateRemoteActors();
+
+    camera.zoom += GetMouseWheelMove() * 0.05f;
+
+    if (camera.zoom > 2.0f)
+    {
+        camera.zoom = 2.0f;
+    }
+    else if (camera.zoom < 0.7f)
+    {
+        camera.zoom = 0.7f;
+    }
+
+    if (IsKeyPressed(KEY_R))
+    {
+        camera.zoom = 1.0f;
+    }
+
+    if (Player* player = world.FindPlayer(localPlayerId))
+    {
+        auto& envItems = world.EnvItems();
+        cameraUpdaters[2 % static_cast<int>(cameraUpdaters.size())](&camera, player,
+            envItems.data(), static_cast<int>(envItems.size()),
+            delta, static_cast<float>(screenWidth), static_cast<float>(screenHeight));
+    }
+}
+
+void Game::ReceiveNetwork()
+{
+    PROFILE_SCOPE("Network receive");
+
+    netClient.poll([this](const uint8_t* data, const std::size_t size) {
+        inbound.clear();
+        if (!decodePacket(data, size, inbound, &snapshots))
+        {
+            return;
+        }
+
+        for (const auto& welcome : inbound.welcomes)
+        {
+            // From here on bots, damage and other players come from the server.
+            serverPlayerId = welcome.playerId;
+            world.Bots().clear();
+            world.SetAuthoritative(false);
+            remotePlayers.clear();
+            botHistory.clear();
+            // Inputs, prediction and replay must step exactly like the
+            // server, which applies one input per tick of its own.
+            const float serverRate = static_cast<float>(welcome.tickRate);
+            if (welcome.tickRate > 0 && fabsf(serverRate - timestep.TickRate()) > 0.01f)
+            {
+                LOG_INFO("[Game] Server ticks at {} Hz, switching from {} Hz", welcome.tickRate, timestep.TickRate());
+                timestep.SetTickRate(serverRate);
+            }
+            snapshotClock.SetTickRate(serverRate);
+            snapshotClock.Reset();
+            recentInputs.clear();
+            snapshots.clear();
+            latestSnapshot = 0;
+            predicted = {};
+            lastPredicted = 0;
+
+            if (preferredRoom >= 0 && welcome.room != static_cast<uint32_t>(preferredRoom))
+            {
+                Packet request;
+                request.joinRooms.push_back({ static_cast<uint32_t>(preferredRoom) });
+                netClient.send(encodePacket(request), Channel::Events);
+                // Once: a full room leaves us where we are.
+                preferredRoom = -1;
+            }
+        }
+
+        if (serverPlayerId == 0)
+        {
+            return;
+        }
+
+        if (!inbound.snapshots.empty() && inbound.snapshots.front().tick > latestSnapshot)
+        {
+            latestSnapshot = inbound.snapshots.front().tick;
+            snapshots.store(latestSnapshot, inbound.players, inbound.bots);
+            snapshotClock.OnSnapshot(latestSnapshot, clientTime);
+            ApplySnapshot(inbound);
+        }
+
+        for (const auto& shot : inbound.shots)
+        {
+            // Our own shots are already in flight locally.
+            if (shot.ownerId == serverPlayerId)
+            {
+                continue;
+            }
+
+            const std::uint8_t team = world.FindBot(shot.ownerId) ? World::BOT_TEAM : World::PLAYER_TEAM;
+            world.Projectiles().Spawn(shot.ownerId, team, shot.origin, shot.velocity, 0);
+        }
+    });
+}
+
+void Game::ApplySnapshot(const Packet& packet)
+{
+    const SnapshotMsg& header = packet.snapshots.front();
+    const double time = snapshotClock.ServerTime(header.tick);
+    const SnapshotHistory::Entry* baseline = header.baseTick != 0 ? snapshots.find(header.baseTick) : nullptr;
+    const double baseTime = snapshotClock.ServerTime(header.baseTick);
+
+    // Both lists arrive sorted by id; anyone missing has left or is out of view.
+    std::erase_if(remotePlayers, [&packet](const auto& entry) { return !findById(packet.players, entry.first); });
+    std::erase_if(botHistory, [&packet](const auto& entry) { return !findById(packet.bots, entry.first); });
 
-    for (auto& bot : bots)
+    for (const auto& state : packet.players)
     {
-        bot.Update(delta, envItems, player.position, particles);
+        if (state.id == serverPlayerId)
+        {
+            Reconcile(header, state);
+        }
+        else
+        {
+            InterpolationBuffer& history = remotePlayers[state.id];
+            if (!IsStaleRepeat(state, baseline ? &baseline->players : nullptr, baseTime, history))
+            {
+                history.Push(time, state.position, state.velocity);
+            }
+        }
     }
 
-    constexpr int PLAYER_BULLET_DAMAGE = 10;
-    for (auto& bot : bots)
+    auto& bots = world.Bots();
+    for (const auto& state : packet.bots)
     {
-        if (bot.IsDead()) continue;
-        const int hits = player.weapon.CheckHit(bot.GetRect(), particles);
-        if (hits > 0)
+        Bot* bot = world.FindBot(state.id);
+        if (!bot)
         {
-            bot.health -= hits * PLAYER_BULLET_DAMAGE;
-            if (bot.health < 0) bot.health = 0;
+            bot = &bots.emplace_back(state.position);
+            bot->id = state.id;
+            bot->showVisionDebug = false;
+        }
+        bot->ApplyReplicatedState(state.position, state.health, static_cast<BotState>(state.state));
+        InterpolationBuffer& history = botHistory[state.id];
+        if (!IsStaleRepeat(state, baseline ? &baseline->bots : nullptr, baseTime, history))
+        {
+            history.Push(time, state.position, state.velocity);
         }
     }
 
-    constexpr float halfWidth  = 10.0f;
-    constexpr float fullHeight = 60.0f;
-    const Rectangle playerRect = {
-        player.position.x - halfWidth,
-        player.position.y - fullHeight,
-        halfWidth * 2.0f,
-        fullHeight
-    };
-    for (auto& bot : bots)
+    // Bots the server no longer reports are dead or out of view.
+    std::erase_if(bots, [&packet](const Bot& bot) { return !findById(packet.bots, bot.id); });
+}
+
+void Game::UpdateRemoteActors()
+{
+    if (serverPlayerId == 0)
+    {
+        return;
+    }
+
+    renderTime = snapshotClock.RenderTime(clientTime);
+    for (auto& bot : world.Bots())
     {
-        if (bot.IsDead()) continue;
-        const int hits = bot.weapon.CheckHit(playerRect, particles);
-        if (hits > 0)
+        const auto it = botHistory.find(bot.id);
+        Vector2 position;
+        if (it != botHistory.end() && it->second.Sample(renderTime, position))
         {
-            const int dmg = static_cast<int>(hits * 10 * bot.damageMultiplier);
-            player.health -= dmg;
-            if (player.health < 0) player.health = 0;
+            bot.previousPosition = position;
+            bot.position = position;
         }
     }
+}
+
+void Game::Reconcile(const SnapshotMsg& header, const PlayerStateMsg& state)
+{
+    Player* player = world.FindPlayer(localPlayerId);
+    if (!player)
+    {
+        return;
+    }
+    player->health = state.health;
+
+    const uint32_t acked = header.ackedInput;
+    const PredictedMove& ackedMove = predicted[acked % PREDICTION_BUFFER];
+    const bool known = acked != 0 && acked <= lastPredicted && lastPredicted - acked < PREDICTION_BUFFER &&
+                       ackedMove.cmd.sequence == acked;
 
-    sendTimer += delta;
-    if (sendTimer >= SEND_PERIOD)
+    if (known && Vector2Distance(ackedMove.position, state.position) <= CORRECTION_EPSILON &&
+        fabsf(ackedMove.speed - header.playerSpeed) <= 1.0f && ackedMove.canJump == header.playerCanJump)
     {
-        sendTimer = 0.0f;
+        return;
+    }
+
+    PROFILE_SCOPE("Reconcile");
+
+    // Rewind to the server's state for the acknowledged input, then replay
+    // every input it hasn't processed yet.
+    const Vector2 before = player->position;
+    player->position = state.position;
+    player->speed = header.playerSpeed;
+    player->canJump = header.playerCanJump;
 
-        char buf[128];
-        if (const int n = snprintf(buf, sizeof(buf), "POS %u %.2f %.2f", clientId, player.position.x, player.position.y); n > 0)
+    if (known)
+    {
+        const float step = timestep.Step();
+        for (uint32_t sequence = acked + 1; sequence <= lastPredicted; ++sequence)
         {
-            const std::vector<uint8_t> v(buf, buf + n);
-            netClient.send(v);
+            PredictedMove& move = predicted[sequence % PREDICTION_BUFFER];
+            if (move.cmd.sequence != sequence)
+            {
+                break;
+            }
+
+            player->Update(step, move.cmd, world.Env());
+            move.position = player->position;
+            move.speed = player->speed;
+            move.canJump = player->canJump;
         }
     }
 
-    camera.zoom += GetMouseWheelMove() * 0.05f;
+    // Keep the drawn position where it was and let the offset decay, unless
+    // the error is too large to hide (spawn, teleport, long stall).
+    const Vector2 shift = Vector2Subtract(player->position, before);
+    player->previousPosition = Vector2Add(player->previousPosition, shift);
+    player->renderOffset = Vector2Subtract(player->renderOffset, shift);
+    if (!known || Vector2Length(player->renderOffset) > CORRECTION_SNAP_DISTANCE)
+    {
+        player->previousPosition = player->position;
+        player->renderOffset = {};
+    }
+}
 
-    if (camera.zoom > 2.0f)
+void Game::SendInput(const InputCommand& cmd)
+{
+    if (serverPlayerId == 0)
     {
-        camera.zoom = 2.0f;
+        return;
     }
-    else if (camera.zoom < 0.7f)
+
+    recentInputs.push_back({ cmd.sequence, cmd.moveX, cmd.jump, cmd.fire, cmd.aim, cmd.spread, cmd.viewTick });
+    while (recentInputs.size() > INPUT_REDUNDANCY)
     {
-        camera.zoom = 0.7f;
+        recentInputs.pop_front();
     }
 
-    if (IsKeyPressed(KEY_R))
+    Packet packet;
+    packet.inputs.assign(recentInputs.begin(), recentInputs.end());
+    if (latestSnapshot != 0)
     {
-        camera.zoom = 1.0f;
+        packet.acks.push_back({ latestSnapshot });
+    }
+    netClient.send(encodePacket(packet), Channel::State);
+}
+
+void Game::Tick(const float delta)
+{
+    PROFILE_SCOPE("Game::Tick");
+
+    if (!headless)
+    {
+        ReceiveNetwork();
     }
 
-    cameraUpdaters[2 % static_cast<int>(cameraUpdaters.size())](&camera, &player, envItems.data(), static_cast<int>(envItems.size()),
-        delta, static_cast<float>(screenWidth), static_cast<float>(screenHeight));
+    InputSource& source = headless ? static_cast<InputSource&>(scriptedInput) : deviceInput;
+    InputCommand cmd = source.Sample();
+    if (serverPlayerId != 0)
+    {
+        // Remote actors on screen are renderTime behind the server; the
+        // server resolves this command's shots against that moment.
+        cmd.viewTick = snapshotClock.TickAt(renderTime);
+    }
+    world.SetInput(localPlayerId, cmd);
+    world.Tick(delta);
 
-    const Vector2 mouseScreen = GetMousePosition();
-    const Vector2 mouseWorld = GetScreenToWorld2D(mouseScreen, camera);
-    const Vector2 weaponAnchor = { player.position.x, player.position.y - 35.0f };
-    player.weapon.Update(delta, weaponAnchor, mouseWorld, envItems, particles, aim.GetRadius());
+    if (headless)
+    {
+        return;
+    }
 
-    for (auto it = particles.begin(); it != particles.end(); )
+    if (Player* player = world.FindPlayer(localPlayerId))
     {
-        if (!it->Update(delta)) 
+        player->renderOffset = Vector2Scale(player->renderOffset, CORRECTION_DECAY);
+
+        if (serverPlayerId != 0)
         {
-            it = particles.erase(it);
+            predicted[cmd.sequence % PREDICTION_BUFFER] = { cmd, player->position, player->speed, player->canJump };
+            lastPredicted = cmd.sequence;
         }
-        else ++it;
     }
+
+    SendInput(cmd);
+    netClient.flush();
 }
 
 void Game::Draw()
 {
+    PROFILE_SCOPE("Game::Draw");
+
+    const float alpha = timestep.Alpha();
+    const Player* player = world.FindPlayer(localPlayerId);
+
     BeginDrawing();
 
         ClearBackground(LIGHTGRAY);
 
         BeginMode2D(camera);
 
-            for (auto &[rect, blocking, color] : envItems)
+            for (auto &[rect, blocking, color] : world.EnvItems())
             {
-                DrawRectangleRec(rect, color);
+                batch.AddRect(rect, color);
             }
 
-            player.Draw();
-
-            for (auto& bot : bots)
+            for (auto& p : world.Players())
             {
-                bot.Draw();
+                p.Draw(batch, alpha);
             }
 
-            for (const auto &[fst, snd] : remotePlayers)
+            for (auto& bot : world.Bots())
             {
-                const auto &[x, y] = snd;
-                const Rectangle r = { x - 10, y - 60, 20.0f, 60.0f };
-                DrawRectangleRec(r, BLUE);
+                bot.Draw(batch, alpha);
             }
-            player.weapon.Draw();
 
-            for (auto &p : particles)
+            for (const auto &[id, history] : remotePlayers)
             {
-                p.Draw();
+                Vector2 position;
+                if (history.Sample(renderTime, position))
+                {
+                    const Rectangle r = { position.x - 10, position.y - 60, 20.0f, 60.0f };
+                    batch.AddRect(r, BLUE);
+                }
             }
+            world.Projectiles().Draw(batch, alpha);
+
+            world.Particles().Draw(batch);
+
+            batch.Flush();
 
         EndMode2D();
 
         const Vector2 mouseScreen2 = GetMousePosition();
         const Vector2 mouseWorld2 = GetScreenToWorld2D(mouseScreen2, camera);
-        aim.Update(player.position, mouseWorld2, camera);
+        if (player)
+        {
+            aim.Update(player->position, mouseWorld2, camera);
+        }
 
 
-        if (player.weapon.IsCooling())
+        if (player && player->weapon.IsCooling())
         {
             aim.SetColor(ORANGE);
         }
@@ -377,5 +640,13 @@ void Game::Draw()
         DrawText("- Space to jump", 40, 60, 10, DARKGRAY);
         DrawText("- Mouse Wheel to Zoom in-out, R to reset zoom", 40, 80, 10, DARKGRAY);
 
+#if defined(WAR_PROFILER_ENABLED)
+        DrawText("- F3 profiler overlay, F4 export war_trace.json", 40, 100, 10, DARKGRAY);
+        if (showProfiler)
+        {
+            DrawProfilerOverlay(screenWidth - 470, 20);
+        }
+#endif
+
     EndDrawing();
 }
@@ -3,53 +3,118 @@
 #include "raylib.h"
 #include <vector>
 
-struct EnvItem {
-    Rectangle rect;
-    int blocking;
-    Color color;
-};
+#include "EnvIndex.h"
 
 #include "Player.h"
 #include "Aim.h"
-#include "Particle.h"
 #include "NetworkClient.h"
-#include "Bot.h"
+#include "World.h"
+#include "Input.h"
+#include "ShapeBatch.h"
+#include "FixedTimestep.h"
+#include "Interpolation.h"
 
+#include <array>
+#include <deque>
 #include <unordered_map>
 #include <cstdint>
 
 class Game
 {
 public:
-    Game(int screenWidth, int screenHeight);
+    // A headless game never touches the window, input devices or network:
+    // the local player is driven by scripted input and nothing is drawn.
+    Game(int screenWidth, int screenHeight, bool headless = false);
     ~Game();
 
     void Update(float delta);
     void Draw();
 
+    // Runs `ticks` fixed simulation steps immediately.
+    void Simulate(int ticks);
+
+    // Also restarts the headless script, which is timed in ticks.
+    void SetTickRate(float tickRate);
+    [[nodiscard]] float TickRate() const { return timestep.TickRate(); }
+    // Minimum delay remote actors are drawn behind the server; the actual
+    // delay grows with measured snapshot spacing and jitter.
+    void SetInterpolationDelay(float seconds) { snapshotClock.SetMinDelay(seconds); }
+    // Match room to ask the server for once it has placed us somewhere.
+    void SetPreferredRoom(int room) { preferredRoom = room; }
+    [[nodiscard]] const World& GetWorld() const { return world; }
+
 private:
     int screenWidth;
     int screenHeight;
+    bool headless;
 
-    Player player{};
-    std::vector<EnvItem> envItems;
-    std::vector<Bot> bots;
+    World world;
+    std::uint32_t localPlayerId = 0;
     Camera2D camera{};
 
     Aim aim{ Aim::Type::Default };
 
-    std::vector<Particle> particles;
+    RaylibInputSource deviceInput;
+    ScriptedInputSource scriptedInput;
 
-    using CameraUpdater = void(*)(Camera2D*, Player*, EnvItem*, int, float, float, float);
+    ShapeBatch batch;
+
+    using CameraUpdater = void(*)(Camera2D*, Player*, const EnvItem*, int, float, float, float);
     std::vector<CameraUpdater> cameraUpdaters;
     int cameraOption = 0;
 
+    FixedTimestep timestep;
+    bool showProfiler = false;
+
     void InitScene();
+    void Tick(float dt);
+
+    void ReceiveNetwork();
+    void ApplySnapshot(const Packet& packet);
+    void UpdateRemoteActors();
+    void Reconcile(const SnapshotMsg& header, const PlayerStateMsg& state);
+    void SendInput(const InputCommand& cmd);
 
     NetworkClient netClient;
-    uint32_t clientId = 0;
-    std::unordered_map<uint32_t, Vector2> remotePlayers;
+    Packet inbound;
+    // Our player's id on the server; 0 until its Welcome arrives.
+    uint32_t serverPlayerId = 0;
+    int preferredRoom = -1;
+    // Decoded snapshots, the baselines for the server's deltas.
+    SnapshotHistory snapshots;
+    uint32_t latestSnapshot = 0;
+
+    // Remote players and bots are drawn from their snapshot history at
+    // renderTime, slightly behind the server, instead of jumping to each
+    // new state as it arrives.
+    SnapshotClock snapshotClock;
+    double clientTime = 0.0;
+    double renderTime = 0.0;
+    std::unordered_map<uint32_t, InterpolationBuffer> remotePlayers;
+    std::unordered_map<uint32_t, InterpolationBuffer> botHistory;
+
+    // Inputs go out unreliably, each packet repeating the last few commands
+    // so a single lost datagram costs the server nothing.
+    std::deque<InputMsg> recentInputs;
+    static inline constexpr std::size_t INPUT_REDUNDANCY = 3;
+
+    // Prediction: the local player moves as soon as input is sampled. Each
+    // move and its resulting state is kept until the server acknowledges
+    // it, so a correction can be replayed on top of the server's state.
+    struct PredictedMove
+    {
+        InputCommand cmd;
+        Vector2 position{};
+        float speed = 0.0f;
+        bool canJump = false;
+    };
+    static inline constexpr std::size_t PREDICTION_BUFFER = 128;
+    std::array<PredictedMove, PREDICTION_BUFFER> predicted{};
+    uint32_t lastPredicted = 0;
 
-    float sendTimer = 0.0f;
-    static inline constexpr float SEND_PERIOD = 0.1f;
+    // Errors below the epsilon are quantization noise; corrections below
+    // the snap distance are blended out over a few ticks.
+    static inline constexpr float CORRECTION_EPSILON = 0.25f;
+    static inline constexpr float CORRECTION_SNAP_DISTANCE = 96.0f;
+    static inline constexpr float CORRECTION_DECAY = 0.8f;
 };
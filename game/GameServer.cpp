@@ -0,0 +1,295 @@
+#include "GameServer.h"
+#include "Log.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#ifdef _WIN32
+// Declared by hand: windows.h clashes with raylib's names.
+extern "C" __declspec(dllimport) unsigned int __stdcall timeBeginPeriod(unsigned int period);
+extern "C" __declspec(dllimport) unsigned int __stdcall timeEndPeriod(unsigned int period);
+#endif
+
+// ENet's hard limit on peers per host.
+static constexpr std::size_t MAX_PEERS = 4095;
+
+GameServer::GameServer(const std::uint16_t port, const float tickRate, const std::size_t roomCount,
+                       const std::size_t workerCount, const std::size_t maxClientsPerRoom)
+    : roomCapacity(std::clamp<std::size_t>(maxClientsPerRoom, 1, MAX_PEERS)),
+      net(port, std::min(std::max<std::size_t>(roomCount, 1) * roomCapacity, MAX_PEERS),
+          std::max<std::size_t>(roomCount, 1), roomCapacity),
+      workerCount(workerCount != 0 ? workerCount
+                                   : std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, net.shardCount()))
+{
+    for (std::size_t i = 0; i < net.shardCount(); ++i)
+    {
+        rooms.push_back(std::make_unique<MatchRoom>(net.shard(i), tickRate));
+    }
+}
+
+GameServer::~GameServer()
+{
+    Stop();
+}
+
+void GameServer::SetStatsOutput(const std::string& path, const std::uint16_t port, const float interval)
+{
+    statsPath = path;
+    statsPort = port;
+    statsInterval = interval > 0.0f ? interval : 5.0f;
+}
+
+bool GameServer::Start()
+{
+    if (running)
+    {
+        return true;
+    }
+
+    if (!net.start())
+    {
+        return false;
+    }
+
+    // Stagger the rooms' ticks across one step so they don't all land on
+    // the workers at the same instant.
+    const auto now = Clock::now();
+    due = {};
+    for (std::size_t i = 0; i < rooms.size(); ++i)
+    {
+        const double phase = rooms[i]->Step() * static_cast<double>(i) / static_cast<double>(rooms.size());
+        due.push({ now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(phase)), i });
+    }
+
+#ifdef _WIN32
+    // Timed waits otherwise round up to the 15.6 ms system tick, a whole
+    // simulation step late.
+    timeBeginPeriod(1);
+#endif
+
+    running = true;
+    for (std::size_t i = 0; i < workerCount; ++i)
+    {
+        workers.emplace_back(&GameServer::WorkerLoop, this);
+    }
+
+    startedAt = now;
+    if (statsPort != 0 && !statsEndpoint.open(statsPort))
+    {
+        LOG_ERROR("[GameServer] Could not serve stats on 127.0.0.1:{}", statsPort);
+    }
+    if (!statsPath.empty() || statsEndpoint.isOpen())
+    {
+        statsThread = std::thread(&GameServer::StatsLoop, this);
+    }
+    return true;
+}
+
+void GameServer::Stop()
+{
+    if (!running)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard lock(dueMutex);
+        running = false;
+    }
+    dueChanged.notify_all();
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+    if (statsThread.joinable())
+    {
+        statsThread.join();
+    }
+    statsEndpoint.close();
+    net.stop();
+
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+}
+
+void GameServer::WorkerLoop()
+{
+    std::unique_lock lock(dueMutex);
+    while (running)
+    {
+        if (due.empty())
+        {
+            dueChanged.wait(lock);
+            continue;
+        }
+
+        const Due next = due.top();
+        if (Clock::now() < next.at)
+        {
+            dueChanged.wait_until(lock, next.at);
+            continue;
+        }
+        due.pop();
+        lock.unlock();
+
+        MatchRoom& room = *rooms[next.room];
+        room.GetMetrics().lateUs.Record(static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - next.at).count()));
+        room.Tick();
+        if (next.room == 0)
+        {
+            // One profiler frame per scheduler pass: the rooms are staggered
+            // across a step, so each frame holds one tick of every room,
+            // whichever workers ran them. Room 0 is never ticked twice at
+            // once, so frames are closed one at a time.
+            PROFILE_FRAME_END();
+        }
+        tickCount.fetch_add(1, std::memory_order_relaxed);
+
+        const auto tickDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(room.Step()));
+        auto at = next.at + tickDuration;
+        if (const auto now = Clock::now(); now - at > tickDuration * 8)
+        {
+            // Hopelessly behind (debugger, suspended VM, overloaded host):
+            // skip instead of bursting.
+            at = now;
+        }
+
+        lock.lock();
+        due.push({ at, next.room });
+        // A sleeping worker may be waiting for a later room than this one.
+        dueChanged.notify_one();
+    }
+}
+
+void GameServer::StatsLoop()
+{
+    // Short enough that Stop() never waits long for this thread.
+    static constexpr Clock::duration SLICE = std::chrono::milliseconds(100);
+
+    const auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(statsInterval));
+
+    ReportState previous;
+    previous.at = startedAt;
+    previous.tickUs.resize(rooms.size());
+    previous.lateUs.resize(rooms.size());
+
+    MetricsText report;
+    report.Comment("No report yet: the first comes one interval after startup");
+
+    auto next = startedAt + interval;
+    while (running)
+    {
+        const auto wait = std::clamp<Clock::duration>(next - Clock::now(), Clock::duration::zero(), SLICE);
+        if (statsEndpoint.isOpen())
+        {
+            statsEndpoint.serve(report.Str(), static_cast<std::uint32_t>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(wait).count()));
+        }
+        else
+        {
+            std::this_thread::sleep_for(wait);
+        }
+
+        if (Clock::now() < next)
+        {
+            continue;
+        }
+        next += interval;
+
+        report.Clear();
+        BuildReport(previous, report);
+
+        if (!statsPath.empty())
+        {
+            std::ofstream out(statsPath, std::ios::app);
+            out << report.Str() << '\n';
+            if (!out)
+            {
+                LOG_WARN("[GameServer] Could not write stats to {}", statsPath);
+            }
+        }
+    }
+}
+
+void GameServer::BuildReport(ReportState& previous, MetricsText& report)
+{
+    ReportState current;
+    current.at = Clock::now();
+    current.ticks = TickCount();
+    current.net = net.stats();
+
+    const double seconds = std::max(std::chrono::duration<double>(current.at - previous.at).count(), 1e-6);
+    const double uptime = std::chrono::duration<double>(current.at - startedAt).count();
+
+    char text[96];
+    std::snprintf(text, sizeof(text), "War server at %.1f s uptime; rates and histograms over the last %.2f s",
+                  uptime, seconds);
+    report.Comment(text);
+
+    report.Add("war_rooms", "", rooms.size());
+    report.Add("war_workers", "", workerCount);
+    report.Add("war_peers", "", current.net.peers.size());
+    report.Add("war_ticks_total", "", current.ticks);
+    report.Add("war_ticks_per_second", "", static_cast<double>(current.ticks - previous.ticks) / seconds);
+
+    const auto rate = [seconds](const std::uint64_t now, const std::uint64_t before) {
+        return static_cast<double>(now - before) / seconds;
+    };
+    report.Add("war_wire_packets_in_total", "", current.net.wirePacketsIn);
+    report.Add("war_wire_bytes_in_total", "", current.net.wireBytesIn);
+    report.Add("war_wire_packets_out_total", "", current.net.wirePacketsOut);
+    report.Add("war_wire_bytes_out_total", "", current.net.wireBytesOut);
+    report.Add("war_wire_packets_in_per_second", "", rate(current.net.wirePacketsIn, previous.net.wirePacketsIn));
+    report.Add("war_wire_bytes_in_per_second", "", rate(current.net.wireBytesIn, previous.net.wireBytesIn));
+    report.Add("war_wire_packets_out_per_second", "", rate(current.net.wirePacketsOut, previous.net.wirePacketsOut));
+    report.Add("war_wire_bytes_out_per_second", "", rate(current.net.wireBytesOut, previous.net.wireBytesOut));
+    report.Add("war_dropped_packets_total", "", net.droppedPackets());
+    report.Add("war_log_dropped_total", "", Log::Get().DroppedCount());
+
+    for (std::size_t i = 0; i < rooms.size(); ++i)
+    {
+        MatchRoom& room = *rooms[i];
+        const MatchRoom::Metrics& metrics = room.GetMetrics();
+        const NetworkServer::Shard& shard = net.shard(i);
+        const std::string labels = "room=\"" + std::to_string(i) + "\"";
+
+        current.tickUs.push_back(metrics.tickUs.Take());
+        current.lateUs.push_back(metrics.lateUs.Take());
+        const Histogram::Summary tick = Histogram::Summarize(current.tickUs[i], previous.tickUs[i]);
+        const Histogram::Summary late = Histogram::Summarize(current.lateUs[i], previous.lateUs[i]);
+
+        report.Add("war_room_clients", labels, metrics.clients.Value());
+        report.Add("war_room_players", labels, metrics.players.Value());
+        report.Add("war_room_bots", labels, metrics.bots.Value());
+        report.Add("war_room_projectiles", labels, metrics.projectiles.Value());
+        report.Add("war_room_pending_inputs", labels, metrics.pendingInputs.Value());
+        report.Add("war_room_inbox_depth", labels, shard.inboxDepth());
+        report.Add("war_room_outgoing_depth", labels, shard.outgoingDepth());
+        report.Add("war_room_dropped_packets_total", labels, shard.droppedPackets());
+        report.Add("war_room_tick_us", labels, tick);
+        report.Add("war_room_late_us", labels, late);
+        // Share of its step the room spends simulating: at 1 it can't keep
+        // up even with a worker to itself.
+        report.Add("war_room_load", labels, tick.mean / (static_cast<double>(room.Step()) * 1e6));
+    }
+
+    for (const NetworkServer::PeerStats& peer : current.net.peers)
+    {
+        const std::string labels = "peer=\"" + std::to_string(peer.id) + "\",room=\"" + std::to_string(peer.room) + "\"";
+        report.Add("war_peer_packets_in_total", labels, peer.packetsIn);
+        report.Add("war_peer_bytes_in_total", labels, peer.bytesIn);
+        report.Add("war_peer_packets_out_total", labels, peer.packetsOut);
+        report.Add("war_peer_bytes_out_total", labels, peer.bytesOut);
+        report.Add("war_peer_rtt_ms", labels, peer.rttMs);
+        report.Add("war_peer_rtt_variance_ms", labels, peer.rttVarianceMs);
+        report.Add("war_peer_packet_loss", labels, static_cast<double>(peer.packetLoss));
+    }
+
+    previous = std::move(current);
+}
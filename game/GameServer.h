@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MatchRoom.h"
+#include "NetworkServer.h"
+#include "StatsEndpoint.h"
+
+// Hosts any number of match rooms behind one port. The network thread
+// assigns each connecting client to the first room with space; a pool of
+// worker threads runs the rooms, each at its own fixed tick, taking
+// whichever room is due next. A room is only ever ticked by one worker at a
+// time, so rooms share nothing but the transport.
+class GameServer
+{
+public:
+    static constexpr std::size_t MAX_CLIENTS_PER_ROOM = 256;
+
+    // `workerCount` 0 uses one worker per core, but never more than rooms.
+    // The total of clients over all rooms is capped at ENet's 4095 peers.
+    explicit GameServer(std::uint16_t port = 1234, float tickRate = 60.0f,
+                        std::size_t roomCount = 1, std::size_t workerCount = 0,
+                        std::size_t maxClientsPerRoom = MAX_CLIENTS_PER_ROOM);
+    ~GameServer();
+
+    // Every `interval` seconds, appends a stats report to `path` (unless
+    // empty) and makes it the one served on 127.0.0.1:`port` (unless 0).
+    // Takes effect at the next Start().
+    void SetStatsOutput(const std::string& path, std::uint16_t port, float interval = 5.0f);
+
+    bool Start();
+    void Stop();
+
+    // Ticks simulated so far, summed over every room.
+    [[nodiscard]] std::uint64_t TickCount() const { return tickCount.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::size_t RoomCount() const { return rooms.size(); }
+    [[nodiscard]] std::size_t RoomCapacity() const { return roomCapacity; }
+    [[nodiscard]] std::size_t WorkerCount() const { return workerCount; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Due
+    {
+        Clock::time_point at;
+        std::size_t room;
+
+        bool operator>(const Due& other) const { return at > other.at; }
+    };
+
+    // Room and network counters as of now; histograms and rates cover the
+    // time since the previous report.
+    struct ReportState
+    {
+        Clock::time_point at;
+        std::uint64_t ticks = 0;
+        NetworkServer::Stats net;
+        std::vector<Histogram::Snapshot> tickUs;
+        std::vector<Histogram::Snapshot> lateUs;
+    };
+
+    void WorkerLoop();
+    void StatsLoop();
+    void BuildReport(ReportState& previous, MetricsText& report);
+
+    std::size_t roomCapacity;
+    NetworkServer net;
+    std::vector<std::unique_ptr<MatchRoom>> rooms;
+    std::size_t workerCount;
+
+    std::vector<std::thread> workers;
+    std::atomic<bool> running{ false };
+    std::atomic<std::uint64_t> tickCount{ 0 };
+
+    // Rooms waiting for their next tick, earliest first. A room being ticked
+    // is out of the queue, which is what keeps it on one worker.
+    std::mutex dueMutex;
+    std::condition_variable dueChanged;
+    std::priority_queue<Due, std::vector<Due>, std::greater<>> due;
+
+    std::string statsPath;
+    std::uint16_t statsPort = 0;
+    float statsInterval = 5.0f;
+    Clock::time_point startedAt;
+    std::thread statsThread;
+    StatsEndpoint statsEndpoint;
+};
@@ -0,0 +1,68 @@
+#include "Input.h"
+#include "raylib.h"
+
+#include <cmath>
+
+void RaylibInputSource::Poll(const Camera2D &camera, const float spreadRadius)
+{
+    pending.moveX = 0.0f;
+    if (IsKeyDown(KEY_A))
+    {
+        pending.moveX -= 1.0f;
+    }
+    if (IsKeyDown(KEY_D))
+    {
+        pending.moveX += 1.0f;
+    }
+
+    if (IsKeyPressed(KEY_W))
+    {
+        pending.jump = true;
+    }
+
+    pending.fire = IsMouseButtonDown(MOUSE_LEFT_BUTTON);
+    pending.aim = GetScreenToWorld2D(GetMousePosition(), camera);
+    pending.spread = spreadRadius;
+}
+
+InputCommand RaylibInputSource::Sample()
+{
+    InputCommand cmd = pending;
+    cmd.sequence = ++sequence;
+    pending.jump = false;
+    return cmd;
+}
+
+ScriptedInputSource::ScriptedInputSource(const unsigned seed, const float tickRate)
+    : rng(seed), tickDelta(1.0f / tickRate) {}
+
+InputCommand ScriptedInputSource::Sample()
+{
+    std::uniform_real_distribution<float> turnDist(1.0f, 3.0f);
+    std::uniform_real_distribution<float> jumpDist(0.8f, 2.5f);
+
+    time += tickDelta;
+    turnTimer -= tickDelta;
+    jumpTimer -= tickDelta;
+
+    InputCommand cmd;
+    cmd.sequence = ++sequence;
+
+    if (turnTimer <= 0.0f)
+    {
+        direction = -direction;
+        turnTimer = turnDist(rng);
+    }
+    cmd.moveX = direction;
+
+    if (jumpTimer <= 0.0f)
+    {
+        cmd.jump = true;
+        jumpTimer = jumpDist(rng);
+    }
+
+    cmd.fire = true;
+    cmd.aim = Vector2{ 1000.0f + 900.0f * cosf(time * 0.9f), 350.0f + 300.0f * sinf(time * 0.6f) };
+    cmd.spread = 10.0f;
+    return cmd;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "raylib.h"
+#include <cstdint>
+#include <random>
+
+// Everything a player can do in one simulation tick. The simulation only
+// ever sees these, so the same World runs from devices, scripts or the wire.
+struct InputCommand
+{
+    std::uint32_t sequence = 0;
+    float moveX = 0.0f;
+    bool jump = false;
+    bool fire = false;
+    Vector2 aim{};
+    float spread = 0.0f;
+    // Server tick the player saw remote actors at when sampling this, for
+    // lag-compensated hits; 0 when playing locally.
+    std::uint32_t viewTick = 0;
+};
+
+class InputSource
+{
+public:
+    virtual ~InputSource() = default;
+
+    // Produces the command for the next simulation tick.
+    virtual InputCommand Sample() = 0;
+};
+
+class RaylibInputSource final : public InputSource
+{
+public:
+    // Reads keyboard and mouse; call once per rendered frame. Jump presses are
+    // latched until the next Sample so they survive frames without a tick.
+    void Poll(const Camera2D &camera, float spreadRadius);
+
+    InputCommand Sample() override;
+
+private:
+    InputCommand pending{};
+    std::uint32_t sequence = 0;
+};
+
+// Deterministic pseudo-player for headless and perf runs: walks back and
+// forth, hops now and then and keeps firing at a target sweeping the map.
+class ScriptedInputSource final : public InputSource
+{
+public:
+    explicit ScriptedInputSource(unsigned seed = 1, float tickRate = 60.0f);
+
+    InputCommand Sample() override;
+
+private:
+    std::mt19937 rng;
+    float tickDelta;
+    float time = 0.0f;
+    float direction = 1.0f;
+    float turnTimer = 0.0f;
+    float jumpTimer = 0.0f;
+    std::uint32_t sequence = 0;
+};
@@ -0,0 +1,105 @@
+#include "InterestGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+InterestGrid::InterestGrid(const float cellSize)
+    : cellSize(cellSize > 1.0f ? cellSize : 1.0f), invCellSize(1.0f / this->cellSize) {}
+
+void InterestGrid::Clear()
+{
+    points.clear();
+    cellStart.clear();
+    cellItems.clear();
+    cols = rows = 0;
+}
+
+void InterestGrid::Add(const Vector2 position)
+{
+    points.push_back(position);
+}
+
+int InterestGrid::CellX(const float x) const
+{
+    return std::clamp(static_cast<int>(floorf((x - bounds.x) * invCellSize)), 0, cols - 1);
+}
+
+int InterestGrid::CellY(const float y) const
+{
+    return std::clamp(static_cast<int>(floorf((y - bounds.y) * invCellSize)), 0, rows - 1);
+}
+
+void InterestGrid::Build()
+{
+    cellStart.clear();
+    cellItems.clear();
+    cols = rows = 0;
+    if (points.empty()) return;
+
+    float minX = points[0].x, minY = points[0].y, maxX = minX, maxY = minY;
+    for (const Vector2& p : points)
+    {
+        minX = fminf(minX, p.x);
+        minY = fminf(minY, p.y);
+        maxX = fmaxf(maxX, p.x);
+        maxY = fmaxf(maxY, p.y);
+    }
+    bounds = { minX, minY, maxX - minX, maxY - minY };
+    // An actor flung far off the map must not blow up the cell count; the
+    // edge cells then just absorb everything beyond them.
+    constexpr float MAX_CELLS_PER_AXIS = 256.0f;
+    cols = static_cast<int>(fminf(floorf(bounds.width  * invCellSize) + 1.0f, MAX_CELLS_PER_AXIS));
+    rows = static_cast<int>(fminf(floorf(bounds.height * invCellSize) + 1.0f, MAX_CELLS_PER_AXIS));
+
+    // Counting pass, then fill; filling in index order keeps every cell's
+    // list ascending.
+    const int count = static_cast<int>(points.size());
+    cellStart.assign(cols * rows + 1, 0);
+    for (const Vector2& p : points)
+    {
+        ++cellStart[CellY(p.y) * cols + CellX(p.x) + 1];
+    }
+    for (int c = 0; c < cols * rows; ++c)
+    {
+        cellStart[c + 1] += cellStart[c];
+    }
+
+    cellItems.resize(count);
+    std::vector<int> cursor(cellStart.begin(), cellStart.end() - 1);
+    for (int i = 0; i < count; ++i)
+    {
+        const Vector2& p = points[i];
+        cellItems[cursor[CellY(p.y) * cols + CellX(p.x)]++] = i;
+    }
+}
+
+void InterestGrid::Query(const Rectangle& area, std::vector<int>& out) const
+{
+    out.clear();
+    if (cols == 0) return;
+
+    const float right = area.x + area.width;
+    const float bottom = area.y + area.height;
+    if (right < bounds.x || bottom < bounds.y ||
+        area.x > bounds.x + bounds.width || area.y > bounds.y + bounds.height)
+    {
+        return;
+    }
+
+    for (int cy = CellY(area.y); cy <= CellY(bottom); ++cy)
+    {
+        for (int cx = CellX(area.x); cx <= CellX(right); ++cx)
+        {
+            const int cell = cy * cols + cx;
+            for (int k = cellStart[cell]; k < cellStart[cell + 1]; ++k)
+            {
+                const Vector2& p = points[cellItems[k]];
+                if (p.x >= area.x && p.x <= right && p.y >= area.y && p.y <= bottom)
+                {
+                    out.push_back(cellItems[k]);
+                }
+            }
+        }
+    }
+    std::sort(out.begin(), out.end());
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "raylib.h"
+#include <vector>
+
+// Uniform grid over moving points (actor positions), rebuilt from scratch
+// whenever the server needs it. Unlike EnvIndex it indexes points, not
+// rectangles, so every entry lives in exactly one cell. Query results are
+// indices in Add order, ascending.
+class InterestGrid
+{
+public:
+    explicit InterestGrid(float cellSize = 256.0f);
+
+    void Clear();
+    void Add(Vector2 position);
+    void Build();
+
+    void Query(const Rectangle& area, std::vector<int>& out) const;
+
+    [[nodiscard]] int Count() const { return static_cast<int>(points.size()); }
+
+private:
+    [[nodiscard]] int CellX(float x) const;
+    [[nodiscard]] int CellY(float y) const;
+
+    float cellSize;
+    float invCellSize;
+
+    std::vector<Vector2> points;
+    Rectangle bounds{};
+    int cols = 0;
+    int rows = 0;
+    std::vector<int> cellStart;
+    std::vector<int> cellItems;
+};
@@ -0,0 +1,107 @@
+#include "Interpolation.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Smoothing factors per snapshot for the clock estimates, and how many
+// jitter deviations of slack the delay keeps on top of two snapshot
+// intervals (enough to ride out one lost snapshot).
+static constexpr double OFFSET_SMOOTHING = 0.02;
+static constexpr double OFFSET_SMOOTHING_EARLY = 0.2;
+static constexpr float INTERVAL_SMOOTHING = 0.1f;
+static constexpr float JITTER_SMOOTHING = 0.1f;
+static constexpr float DELAY_SMOOTHING = 0.05f;
+static constexpr float JITTER_MARGIN = 2.5f;
+
+void SnapshotClock::Reset()
+{
+    synced = false;
+    lastTick = 0;
+    offset = 0.0;
+    interval = 0.0f;
+    jitter = 0.0f;
+    delay = std::max(minDelay, 0.1f);
+}
+
+void SnapshotClock::OnSnapshot(const std::uint32_t tick, const double localTime)
+{
+    const double sample = ServerTime(tick) - localTime;
+    if (!synced)
+    {
+        synced = true;
+        lastTick = tick;
+        offset = sample;
+        return;
+    }
+
+    if (tick > lastTick)
+    {
+        const float spacing = static_cast<float>((tick - lastTick) * serverStep);
+        interval = interval == 0.0f ? spacing : interval + (spacing - interval) * INTERVAL_SMOOTHING;
+        lastTick = tick;
+    }
+
+    // An early snapshot means the estimate is too pessimistic, a late one
+    // is usually jitter: follow the former faster than the latter.
+    const double error = sample - offset;
+    offset += error * (error > 0.0 ? OFFSET_SMOOTHING_EARLY : OFFSET_SMOOTHING);
+    jitter += (static_cast<float>(std::fabs(error)) - jitter) * JITTER_SMOOTHING;
+
+    const float target = std::clamp(2.0f * interval + JITTER_MARGIN * jitter, minDelay, std::max(minDelay, MAX_DELAY));
+    delay += (target - delay) * DELAY_SMOOTHING;
+}
+
+std::uint32_t SnapshotClock::TickAt(const double serverTime) const
+{
+    return serverTime > 0.0 ? static_cast<std::uint32_t>(std::lround(serverTime / serverStep)) : 0;
+}
+
+void InterpolationBuffer::Push(const double time, const Vector2 position, const Vector2 velocity)
+{
+    if (count > 0 && time <= At(count - 1).time)
+    {
+        return;
+    }
+
+    if (count == CAPACITY)
+    {
+        head = (head + 1) % CAPACITY;
+        --count;
+    }
+    entries[(head + count) % CAPACITY] = { time, position, velocity };
+    ++count;
+}
+
+bool InterpolationBuffer::Sample(const double time, Vector2& out) const
+{
+    if (count == 0)
+    {
+        return false;
+    }
+
+    if (time <= At(0).time)
+    {
+        out = At(0).position;
+        return true;
+    }
+
+    const Entry& newest = At(count - 1);
+    if (time >= newest.time)
+    {
+        const float ahead = static_cast<float>(std::min(time - newest.time, static_cast<double>(MAX_EXTRAPOLATION)));
+        out = { newest.position.x + newest.velocity.x * ahead, newest.position.y + newest.velocity.y * ahead };
+        return true;
+    }
+
+    std::size_t i = count - 1;
+    while (At(i - 1).time > time)
+    {
+        --i;
+    }
+
+    const Entry& a = At(i - 1);
+    const Entry& b = At(i);
+    const float t = static_cast<float>((time - a.time) / (b.time - a.time));
+    out = { a.position.x + (b.position.x - a.position.x) * t, a.position.y + (b.position.y - a.position.y) * t };
+    return true;
+}
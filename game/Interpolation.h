@@ -0,0 +1,75 @@
+#pragma once
+
+#include "raylib.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Maps local time onto the server's timeline for drawing remote actors a
+// little in the past, where two snapshots usually bracket the moment drawn.
+// The delay adapts to the measured snapshot spacing and arrival jitter.
+class SnapshotClock
+{
+public:
+    void Reset();
+    void SetTickRate(float tickRate) { serverStep = 1.0 / tickRate; }
+    // Floor for the adaptive delay.
+    void SetMinDelay(float seconds) { minDelay = seconds; }
+
+    void OnSnapshot(std::uint32_t tick, double localTime);
+
+    // Server time to draw remote actors at.
+    [[nodiscard]] double RenderTime(double localTime) const { return localTime + offset - delay; }
+    [[nodiscard]] double ServerTime(std::uint32_t tick) const { return tick * serverStep; }
+    // Nearest server tick to a server time.
+    [[nodiscard]] std::uint32_t TickAt(double serverTime) const;
+
+    [[nodiscard]] float Delay() const { return delay; }
+    [[nodiscard]] float Jitter() const { return jitter; }
+
+    static constexpr float MAX_DELAY = 0.3f;
+
+private:
+    double serverStep = 1.0 / 60.0;
+    float minDelay = 0.05f;
+
+    bool synced = false;
+    std::uint32_t lastTick = 0;
+    double offset = 0.0;
+    float interval = 0.0f;
+    float jitter = 0.0f;
+    float delay = 0.1f;
+};
+
+// Recent timestamped positions of one remote actor.
+class InterpolationBuffer
+{
+public:
+    void Push(double time, Vector2 position, Vector2 velocity);
+
+    // Position at `time`: interpolated between the bracketing samples, or
+    // extrapolated from the newest one for up to MAX_EXTRAPOLATION when
+    // snapshots are late. False when empty.
+    bool Sample(double time, Vector2& out) const;
+
+    [[nodiscard]] bool Empty() const { return count == 0; }
+    // Time of the newest sample, 0 when empty.
+    [[nodiscard]] double NewestTime() const { return count > 0 ? At(count - 1).time : 0.0; }
+
+    static constexpr std::size_t CAPACITY = 32;
+    static constexpr float MAX_EXTRAPOLATION = 0.15f;
+
+private:
+    struct Entry
+    {
+        double time;
+        Vector2 position;
+        Vector2 velocity;
+    };
+
+    [[nodiscard]] const Entry& At(std::size_t i) const { return entries[(head + i) % CAPACITY]; }
+
+    std::array<Entry, CAPACITY> entries{};
+    std::size_t head = 0;
+    std::size_t count = 0;
+};
@@ -0,0 +1,400 @@
+#include <enet/enet.h>
+#include "LoadTest.h"
+#include "Input.h"
+#include "Log.h"
+#include "MatchRoom.h"
+#include "Protocol.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <deque>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// As in Game: every packet repeats the last few inputs.
+static constexpr std::size_t INPUT_REDUNDANCY = 3;
+// Send times kept per client; an input acked later than this many inputs
+// after it was sent goes untimed.
+static constexpr std::size_t INPUT_WINDOW = 256;
+static constexpr Clock::duration CONNECT_TIMEOUT = std::chrono::seconds(5);
+// Longest a worker blocks in ENet while nothing is due.
+static constexpr Clock::duration IDLE_WAIT = std::chrono::milliseconds(10);
+
+namespace
+{
+    struct SimClient
+    {
+        enum class State { Waiting, Connecting, Connected, Gone };
+
+        State state = State::Waiting;
+        ENetPeer* peer = nullptr;
+        Clock::time_point connectAt;
+        Clock::time_point connectDeadline;
+        unsigned seed = 1;
+
+        std::uint32_t playerId = 0;
+        ScriptedInputSource input;
+        Clock::duration step{};
+        Clock::time_point nextInput;
+
+        std::deque<InputMsg> recent;
+        std::array<Clock::time_point, INPUT_WINDOW> sentAt{};
+        std::uint32_t lastSequence = 0;
+        std::uint32_t ackedInput = 0;
+
+        std::uint32_t latestSnapshot = 0;
+        SnapshotHistory snapshots;
+    };
+}
+
+LoadTest::LoadTest(const Options& options)
+    : options(options)
+{
+    this->options.clients = std::max<std::size_t>(options.clients, 1);
+    this->options.threads = std::clamp<std::size_t>(options.threads, 1, this->options.clients);
+}
+
+bool LoadTest::Run()
+{
+    if (enet_initialize() != 0)
+    {
+        LOG_ERROR("[LoadTest] ENet initialization failed");
+        return false;
+    }
+
+    std::printf("Load test: %zu clients on %zu threads against %s:%u for %.0f s (%.0f s ramp-up)\n",
+                options.clients, options.threads, options.host.c_str(), static_cast<unsigned>(options.port), options.seconds,
+                options.rampSeconds);
+    std::fflush(stdout);
+
+    startedAt = Clock::now();
+    running = true;
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < options.threads; ++i)
+    {
+        workers.emplace_back(&LoadTest::RunWorker, this, i);
+    }
+
+    const auto end = startedAt + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.seconds));
+    auto next = startedAt + std::chrono::seconds(1);
+    auto lastReport = startedAt;
+    Histogram::Snapshot lastLatency;
+    std::uint64_t lastSnapshots = 0;
+    std::uint64_t lastMissed = 0;
+    std::uint64_t lastPacketsIn = 0;
+    std::uint64_t lastBytesIn = 0;
+    std::uint64_t lastPacketsOut = 0;
+    std::uint64_t lastBytesOut = 0;
+
+    while (Clock::now() < end)
+    {
+        std::this_thread::sleep_until(std::min(next, end));
+        const auto now = Clock::now();
+        const double seconds = std::chrono::duration<double>(now - startedAt).count();
+        const double interval = std::max(std::chrono::duration<double>(now - lastReport).count(), 1e-3);
+        lastReport = now;
+        next += std::chrono::seconds(1);
+
+        const Histogram::Snapshot latency = totals.inputLatencyUs.Take();
+        const Histogram::Summary recent = Histogram::Summarize(latency, lastLatency);
+        lastLatency = latency;
+
+        const auto delta = [](const Counter& counter, std::uint64_t& last) {
+            const std::uint64_t value = counter.Value();
+            const std::uint64_t d = value - last;
+            last = value;
+            return d;
+        };
+        const double snapshots = static_cast<double>(delta(totals.snapshots, lastSnapshots));
+        const double missed = static_cast<double>(delta(totals.snapshotsMissed, lastMissed));
+        const double packetsIn = static_cast<double>(delta(totals.wirePacketsIn, lastPacketsIn));
+        const double bytesIn = static_cast<double>(delta(totals.wireBytesIn, lastBytesIn));
+        const double packetsOut = static_cast<double>(delta(totals.wirePacketsOut, lastPacketsOut));
+        const double bytesOut = static_cast<double>(delta(totals.wireBytesOut, lastBytesOut));
+
+        const std::uint64_t connected = totals.connected.Value();
+        const std::uint64_t gone = totals.dropped.Value();
+        std::printf("%5.0fs  clients %llu/%zu (%llu failed, %llu dropped)  in %.0f pkt/s %.1f KB/s  "
+                    "out %.0f pkt/s %.1f KB/s  snapshots %.0f/s (%.1f%% missed)  input latency ms p50 %.1f p99 %.1f\n",
+                    seconds, static_cast<unsigned long long>(connected - gone), options.clients,
+                    static_cast<unsigned long long>(totals.failed.Value()), static_cast<unsigned long long>(gone),
+                    packetsIn / interval, bytesIn / interval / 1024.0, packetsOut / interval, bytesOut / interval / 1024.0,
+                    snapshots / interval, snapshots + missed > 0 ? 100.0 * missed / (snapshots + missed) : 0.0,
+                    static_cast<double>(recent.p50) / 1000.0, static_cast<double>(recent.p99) / 1000.0);
+        std::fflush(stdout);
+    }
+
+    running = false;
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    enet_deinitialize();
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - startedAt).count();
+    const auto perSecond = [seconds](const Counter& counter) { return static_cast<double>(counter.Value()) / seconds; };
+    const Histogram::Summary latency = Histogram::Summarize(totals.inputLatencyUs.Take(), {});
+    const Histogram::Summary rtt = Histogram::Summarize(totals.rttMs.Take(), {});
+    const double snapshots = static_cast<double>(totals.snapshots.Value());
+    const double missed = static_cast<double>(totals.snapshotsMissed.Value());
+
+    std::printf("\n=== Load test summary (%.1f s) ===\n", seconds);
+    std::printf("Clients:     %llu connected, %llu failed to connect, %llu dropped by the server\n",
+                static_cast<unsigned long long>(totals.connected.Value()),
+                static_cast<unsigned long long>(totals.failed.Value()),
+                static_cast<unsigned long long>(totals.dropped.Value()));
+    std::printf("Throughput:  in %.0f pkt/s %.1f KB/s, out %.0f pkt/s %.1f KB/s; %.0f inputs/s, %.0f snapshots/s\n",
+                perSecond(totals.wirePacketsIn), perSecond(totals.wireBytesIn) / 1024.0,
+                perSecond(totals.wirePacketsOut), perSecond(totals.wireBytesOut) / 1024.0,
+                perSecond(totals.inputsSent), perSecond(totals.snapshots));
+    std::printf("Snapshots:   %.2f%% missed, %llu arrived out of order, %llu failed to decode\n",
+                snapshots + missed > 0 ? 100.0 * missed / (snapshots + missed) : 0.0,
+                static_cast<unsigned long long>(totals.snapshotsStale.Value()),
+                static_cast<unsigned long long>(totals.decodeErrors.Value()));
+    std::printf("Input->ack:  %llu timed, ms mean %.1f p50 %.1f p90 %.1f p99 %.1f max %.1f\n",
+                static_cast<unsigned long long>(latency.count), latency.mean / 1000.0,
+                static_cast<double>(latency.p50) / 1000.0, static_cast<double>(latency.p90) / 1000.0,
+                static_cast<double>(latency.p99) / 1000.0, static_cast<double>(latency.max) / 1000.0);
+    std::printf("ENet RTT:    ms p50 %llu p99 %llu max %llu\n",
+                static_cast<unsigned long long>(rtt.p50), static_cast<unsigned long long>(rtt.p99),
+                static_cast<unsigned long long>(rtt.max));
+    std::fflush(stdout);
+
+    return totals.connected.Value() > 0;
+}
+
+void LoadTest::RunWorker(const std::size_t index)
+{
+    const std::size_t first = options.clients * index / options.threads;
+    const std::size_t last = options.clients * (index + 1) / options.threads;
+    std::vector<SimClient> clients(last - first);
+
+    ENetHost* host = enet_host_create(nullptr, clients.size(), CHANNEL_COUNT, 0, 0);
+    if (!host)
+    {
+        LOG_ERROR("[LoadTest] Could not create an ENet host for {} clients", clients.size());
+        totals.failed.Add(clients.size());
+        return;
+    }
+
+    ENetAddress address;
+    enet_address_set_host(&address, options.host.c_str());
+    address.port = options.port;
+
+    const auto ramp = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.rampSeconds));
+    for (std::size_t i = 0; i < clients.size(); ++i)
+    {
+        clients[i].connectAt = startedAt + ramp * static_cast<Clock::rep>(first + i) / static_cast<Clock::rep>(options.clients);
+        clients[i].seed = static_cast<unsigned>(first + i + 1);
+    }
+
+    Packet inbound;
+    Packet outbound;
+    BitWriter writer;
+    std::vector<std::uint8_t> datagram;
+
+    const auto sendInput = [&](SimClient& client, const Clock::time_point now) {
+        InputCommand cmd = client.input.Sample();
+        cmd.viewTick = client.latestSnapshot;
+        client.recent.push_back({ cmd.sequence, cmd.moveX, cmd.jump, cmd.fire, cmd.aim, cmd.spread, cmd.viewTick });
+        while (client.recent.size() > INPUT_REDUNDANCY)
+        {
+            client.recent.pop_front();
+        }
+        client.sentAt[cmd.sequence % INPUT_WINDOW] = now;
+        client.lastSequence = cmd.sequence;
+
+        outbound.clear();
+        outbound.inputs.assign(client.recent.begin(), client.recent.end());
+        if (client.latestSnapshot != 0)
+        {
+            outbound.acks.push_back({ client.latestSnapshot });
+        }
+        writer.clear();
+        encodePacket(outbound, writer);
+        datagram.clear();
+        appendFrame(datagram, writer.data().data(), writer.data().size());
+
+        ENetPacket* packet = enet_packet_create(datagram.data(), datagram.size(), 0);
+        if (enet_peer_send(client.peer, static_cast<enet_uint8>(Channel::State), packet) < 0)
+        {
+            enet_packet_destroy(packet);
+            return;
+        }
+        totals.inputsSent.Add();
+    };
+
+    const auto receive = [&](SimClient& client, const std::uint8_t* data, const std::size_t size, const Clock::time_point now) {
+        inbound.clear();
+        if (!decodePacket(data, size, inbound, &client.snapshots))
+        {
+            totals.decodeErrors.Add();
+            return;
+        }
+
+        for (const auto& welcome : inbound.welcomes)
+        {
+            const float tickRate = welcome.tickRate > 0 ? static_cast<float>(welcome.tickRate) : 60.0f;
+            client.playerId = welcome.playerId;
+            client.input = ScriptedInputSource(client.seed, tickRate);
+            client.step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / tickRate));
+            client.nextInput = now;
+            client.recent.clear();
+            client.lastSequence = 0;
+            client.ackedInput = 0;
+            client.latestSnapshot = 0;
+            client.snapshots.clear();
+        }
+
+        if (client.playerId == 0 || inbound.snapshots.empty())
+        {
+            return;
+        }
+
+        const SnapshotMsg& snapshot = inbound.snapshots.front();
+        totals.snapshots.Add();
+        if (snapshot.tick <= client.latestSnapshot)
+        {
+            totals.snapshotsStale.Add();
+            return;
+        }
+
+        const std::uint32_t interval = MatchRoom::SNAPSHOT_INTERVAL_TICKS;
+        if (client.latestSnapshot != 0 && snapshot.tick - client.latestSnapshot > interval)
+        {
+            totals.snapshotsMissed.Add((snapshot.tick - client.latestSnapshot) / interval - 1);
+        }
+        client.latestSnapshot = snapshot.tick;
+        client.snapshots.store(snapshot.tick, inbound.players, inbound.bots);
+
+        const std::uint32_t acked = std::min(snapshot.ackedInput, client.lastSequence);
+        for (std::uint32_t sequence = client.ackedInput + 1; sequence <= acked; ++sequence)
+        {
+            if (client.lastSequence - sequence < INPUT_WINDOW)
+            {
+                totals.inputLatencyUs.Record(static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(now - client.sentAt[sequence % INPUT_WINDOW]).count()));
+            }
+        }
+        client.ackedInput = std::max(client.ackedInput, acked);
+    };
+
+    while (running)
+    {
+        const auto now = Clock::now();
+        auto wake = now + IDLE_WAIT;
+
+        for (SimClient& client : clients)
+        {
+            switch (client.state)
+            {
+                case SimClient::State::Waiting:
+                    if (now < client.connectAt)
+                    {
+                        wake = std::min(wake, client.connectAt);
+                        break;
+                    }
+                    client.peer = enet_host_connect(host, &address, CHANNEL_COUNT, 0);
+                    if (!client.peer)
+                    {
+                        totals.failed.Add();
+                        client.state = SimClient::State::Gone;
+                        break;
+                    }
+                    client.peer->data = &client;
+                    client.connectDeadline = now + CONNECT_TIMEOUT;
+                    client.state = SimClient::State::Connecting;
+                    break;
+                case SimClient::State::Connecting:
+                    if (now >= client.connectDeadline)
+                    {
+                        enet_peer_reset(client.peer);
+                        totals.failed.Add();
+                        client.state = SimClient::State::Gone;
+                    }
+                    break;
+                case SimClient::State::Connected:
+                    if (client.playerId == 0)
+                    {
+                        break;
+                    }
+                    if (now >= client.nextInput)
+                    {
+                        sendInput(client, now);
+                        client.nextInput += client.step;
+                        if (now - client.nextInput > client.step * 8)
+                        {
+                            // Stalled: skip ahead instead of bursting.
+                            client.nextInput = now;
+                        }
+                    }
+                    wake = std::min(wake, client.nextInput);
+                    break;
+                case SimClient::State::Gone:
+                    break;
+            }
+        }
+
+        // Blocks until a datagram arrives or the next input is due; with no
+        // timeout left this still sends what was just queued.
+        const auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(std::max(wake - Clock::now(), Clock::duration::zero()));
+        ENetEvent event;
+        int result = enet_host_service(host, &event, static_cast<enet_uint32>(timeout.count()));
+        while (result > 0)
+        {
+            auto* client = static_cast<SimClient*>(event.peer->data);
+            switch (event.type)
+            {
+                case ENET_EVENT_TYPE_CONNECT:
+                    client->state = SimClient::State::Connected;
+                    totals.connected.Add();
+                    break;
+                case ENET_EVENT_TYPE_DISCONNECT:
+                    // Refused (every room full) or dropped after joining.
+                    (client->state == SimClient::State::Connected ? totals.dropped : totals.failed).Add();
+                    client->state = SimClient::State::Gone;
+                    break;
+                case ENET_EVENT_TYPE_RECEIVE:
+                {
+                    const auto received = Clock::now();
+                    forEachFrame(event.packet->data, event.packet->dataLength,
+                        [&](const std::uint8_t* data, const std::size_t size) {
+                            receive(*client, data, size, received);
+                        });
+                    enet_packet_destroy(event.packet);
+                    break;
+                }
+                default:
+                    break;
+            }
+            result = enet_host_service(host, &event, 0);
+        }
+
+        totals.wirePacketsIn.Add(host->totalReceivedPackets);
+        totals.wireBytesIn.Add(host->totalReceivedData);
+        totals.wirePacketsOut.Add(host->totalSentPackets);
+        totals.wireBytesOut.Add(host->totalSentData);
+        host->totalReceivedPackets = 0;
+        host->totalReceivedData = 0;
+        host->totalSentPackets = 0;
+        host->totalSentData = 0;
+    }
+
+    for (SimClient& client : clients)
+    {
+        if (client.state == SimClient::State::Connected)
+        {
+            totals.rttMs.Record(client.peer->roundTripTime);
+            enet_peer_disconnect(client.peer, 0);
+        }
+        else if (client.state == SimClient::State::Connecting)
+        {
+            enet_peer_reset(client.peer);
+        }
+    }
+    enet_host_flush(host);
+    enet_host_destroy(host);
+}
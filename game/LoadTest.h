@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Metrics.h"
+
+// Headless client swarm for finding how many players a server can carry.
+// The simulated clients are spread over a few threads; each thread drives
+// one ENet host holding its share of the connections. Every client plays a
+// ScriptedInputSource at the server's tick rate and talks the same protocol
+// as Game: redundant inputs, acknowledged snapshots, delta baselines. It
+// times every input from its send to the first snapshot that reports it
+// applied, which covers both network legs, the wait for the server's tick
+// and the wait for the next snapshot.
+class LoadTest
+{
+public:
+    struct Options
+    {
+        std::string host = "127.0.0.1";
+        std::uint16_t port = 1234;
+        std::size_t clients = 64;
+        std::size_t threads = 4;
+        float seconds = 30.0f;
+        // Connections are spread evenly over this long, so the server's
+        // behaviour can be watched as the load builds up.
+        float rampSeconds = 5.0f;
+    };
+
+    explicit LoadTest(const Options& options);
+
+    // Runs for the configured time, printing a line per second and a
+    // summary at the end. False if no client ever got in.
+    bool Run();
+
+private:
+    struct Totals
+    {
+        Counter connected;
+        Counter failed;
+        Counter dropped;
+        Counter inputsSent;
+        Counter snapshots;
+        // Snapshots the server sent that never arrived, from gaps in the
+        // tick numbers, and ones that arrived after a newer one.
+        Counter snapshotsMissed;
+        Counter snapshotsStale;
+        Counter decodeErrors;
+        Counter wirePacketsIn;
+        Counter wireBytesIn;
+        Counter wirePacketsOut;
+        Counter wireBytesOut;
+        Histogram inputLatencyUs;
+        Histogram rttMs;
+    };
+
+    void RunWorker(std::size_t index);
+
+    Options options;
+    Totals totals;
+    std::chrono::steady_clock::time_point startedAt;
+    std::atomic<bool> running{ false };
+};
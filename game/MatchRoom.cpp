@@ -0,0 +1,416 @@
+#include "MatchRoom.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ranges>
+
+static constexpr Vector2 SPAWN_POINTS[] = {
+    { 100.0f, 500.0f }, { 1800.0f, 500.0f }, { 300.0f, 680.0f },
+    { 1500.0f, 680.0f }, { 1000.0f, 680.0f }, { 700.0f, 300.0f },
+};
+
+static InputCommand ToCommand(const InputMsg& msg)
+{
+    InputCommand cmd;
+    cmd.sequence = msg.sequence;
+    cmd.moveX = msg.moveX;
+    cmd.jump = msg.jump;
+    cmd.fire = msg.fire;
+    cmd.aim = msg.aim;
+    cmd.spread = msg.spread;
+    cmd.viewTick = msg.viewTick;
+    return cmd;
+}
+
+static Vector2 VelocityOf(const Vector2 pos, const Vector2 prev, const float step)
+{
+    return { (pos.x - prev.x) / step, (pos.y - prev.y) / step };
+}
+
+static std::uint8_t HealthByte(const int health)
+{
+    return static_cast<std::uint8_t>(std::clamp(health, 0, 255));
+}
+
+static constexpr float PLAYER_PRIORITY = 1.0f;
+static constexpr float BOT_PRIORITY = 0.75f;
+
+MatchRoom::MatchRoom(NetworkServer::Shard& net, const float tickRate)
+    : net(net), tickRate(tickRate), step(1.0f / tickRate)
+{
+    world.InitScene();
+    world.SetLagCompensation(LAG_COMPENSATION_WINDOW);
+}
+
+void MatchRoom::Tick()
+{
+    PROFILE_SCOPE("MatchRoom::Tick");
+    const auto start = std::chrono::steady_clock::now();
+
+    net.poll([this](const NetworkServer::EventType type, const std::uint32_t peer,
+                    const std::uint8_t* data, const std::size_t size) {
+        OnEvent(type, peer, data, size);
+    });
+
+    ApplyInputs();
+    world.Tick(step);
+
+    UpdateViews();
+    SendEvents();
+    if (world.TickCount() % SNAPSHOT_INTERVAL_TICKS == 0)
+    {
+        SendSnapshots();
+    }
+
+    net.flush();
+
+    std::size_t pending = 0;
+    for (const auto& [peer, client] : clients)
+    {
+        pending += client.pending.size();
+    }
+    metrics.clients.Set(static_cast<std::int64_t>(clients.size()));
+    metrics.players.Set(static_cast<std::int64_t>(world.Players().size()));
+    metrics.bots.Set(static_cast<std::int64_t>(world.Bots().size()));
+    metrics.projectiles.Set(static_cast<std::int64_t>(world.Projectiles().Count()));
+    metrics.pendingInputs.Set(static_cast<std::int64_t>(pending));
+    metrics.tickUs.Record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count()));
+}
+
+void MatchRoom::OnEvent(const NetworkServer::EventType type, const std::uint32_t peer,
+                         const std::uint8_t* data, const std::size_t size)
+{
+    switch (type)
+    {
+        case NetworkServer::EventType::Connect:
+        {
+            const Vector2 spawn = SPAWN_POINTS[spawnCursor++ % std::size(SPAWN_POINTS)];
+            Client& client = clients[peer];
+            client.playerId = world.AddPlayer(spawn);
+
+            outbound.clear();
+            outbound.welcomes.push_back({ client.playerId, static_cast<std::uint32_t>(tickRate),
+                                         static_cast<std::uint32_t>(net.index()) });
+            writer.clear();
+            encodePacket(outbound, writer);
+            net.send(peer, writer.data(), Channel::Events);
+            break;
+        }
+        case NetworkServer::EventType::Disconnect:
+        {
+            if (const auto it = clients.find(peer); it != clients.end())
+            {
+                world.RemovePlayer(it->second.playerId);
+                clients.erase(it);
+            }
+            break;
+        }
+        case NetworkServer::EventType::Receive:
+        {
+            const auto it = clients.find(peer);
+            if (it == clients.end())
+            {
+                break;
+            }
+
+            inbound.clear();
+            if (!decodePacket(data, size, inbound))
+            {
+                break;
+            }
+
+            // Inputs arrive with redundant copies of earlier ones; keep only new ones.
+            Client& client = it->second;
+            for (const auto& input : inbound.inputs)
+            {
+                if (input.sequence > client.lastReceived)
+                {
+                    client.lastReceived = input.sequence;
+                    client.pending.push_back(input);
+                }
+            }
+            std::sort(client.pending.begin(), client.pending.end(),
+                      [](const InputMsg& a, const InputMsg& b) { return a.sequence < b.sequence; });
+
+            for (const auto& ack : inbound.acks)
+            {
+                if (ack.tick > client.ackedSnapshot && ack.tick <= world.TickCount())
+                {
+                    client.ackedSnapshot = ack.tick;
+                }
+            }
+
+            // The move happens on the network thread; this room then sees
+            // the client disconnect and the other one sees it connect.
+            for (const auto& join : inbound.joinRooms)
+            {
+                net.transfer(peer, join.room);
+            }
+            break;
+        }
+    }
+}
+
+void MatchRoom::ApplyInputs()
+{
+    for (auto& [peer, client] : clients)
+    {
+        // A client running ahead would otherwise build up ever more latency.
+        while (client.pending.size() > MAX_PENDING_INPUTS)
+        {
+            client.pending.pop_front();
+        }
+
+        if (client.pending.empty())
+        {
+            // Starved: the player keeps the last command (minus the jump edge).
+            continue;
+        }
+
+        const InputMsg input = client.pending.front();
+        client.pending.pop_front();
+        client.lastApplied = input.sequence;
+        world.SetInput(client.playerId, ToCommand(input));
+    }
+}
+
+void MatchRoom::UpdateViews()
+{
+    for (auto& [peer, client] : clients)
+    {
+        // A client whose player is gone keeps watching where it last was.
+        if (const Player* player = world.FindPlayer(client.playerId))
+        {
+            client.view = {
+                player->position.x - VIEW_HALF_WIDTH - VIEW_MARGIN,
+                player->position.y - VIEW_HALF_HEIGHT - VIEW_MARGIN,
+                2.0f * (VIEW_HALF_WIDTH + VIEW_MARGIN),
+                2.0f * (VIEW_HALF_HEIGHT + VIEW_MARGIN)
+            };
+        }
+    }
+}
+
+void MatchRoom::SendEvents()
+{
+    const auto& spawns = world.Projectiles().SpawnLog();
+    const auto& hits = world.LastHits();
+    if (spawns.empty() && hits.empty())
+    {
+        return;
+    }
+
+    for (const auto& [peer, client] : clients)
+    {
+        outbound.clear();
+        for (const auto& spawn : spawns)
+        {
+            // The shooter already fired it locally.
+            if (spawn.ownerId != client.playerId && CheckCollisionPointRec(spawn.pos, client.view))
+            {
+                outbound.shots.push_back({ spawn.ownerId, spawn.pos, spawn.vel });
+            }
+        }
+        for (const auto& hit : hits)
+        {
+            if (hit.ownerId == client.playerId || hit.targetId == client.playerId ||
+                CheckCollisionPointRec(hit.point, client.view))
+            {
+                outbound.hits.push_back({ hit.ownerId, hit.targetId, static_cast<std::uint32_t>(std::max(hit.damage, 0)), hit.point });
+            }
+        }
+        if (outbound.empty())
+        {
+            continue;
+        }
+
+        writer.clear();
+        encodePacket(outbound, writer);
+        net.send(peer, writer.data(), Channel::Events);
+    }
+}
+
+void MatchRoom::ScheduleActors(Client& client, const SnapshotHistory::Entry* baseline, const SnapshotMsg& header,
+                               const std::size_t budget)
+{
+    const std::size_t playerCount = playerStates.size();
+    const std::uint32_t tick = world.TickCount();
+
+    const Vector2 center = {
+        client.view.x + client.view.width * 0.5f,
+        client.view.y + client.view.height * 0.5f
+    };
+
+    // What each visible actor costs as the encoder will write it: nothing
+    // if unchanged since the baseline, a delta if the baseline has it,
+    // in full otherwise.
+    const auto cost = [&](const std::size_t index) {
+        if (index < playerCount)
+        {
+            const PlayerStateMsg& state = playerStates[index];
+            return snapshotEntityBits(state, baseline ? findById(baseline->players, state.id) : nullptr);
+        }
+        const BotStateMsg& state = botStates[index - playerCount];
+        return snapshotEntityBits(state, baseline ? findById(baseline->bots, state.id) : nullptr);
+    };
+
+    scheduled.assign(visible.size(), 0);
+    candidates.clear();
+    const std::size_t budgetBits = budget * 8;
+    std::size_t used = snapshotHeaderBits(header);
+
+    // Baseline actors that are no longer in view are sent as removals.
+    // Price every baseline actor as one and refund those still in view.
+    if (baseline)
+    {
+        for (const auto& state : baseline->players) used += snapshotRemovalBits(state.id);
+        for (const auto& state : baseline->bots) used += snapshotRemovalBits(state.id);
+    }
+
+    for (int k = 0; k < static_cast<int>(visible.size()); ++k)
+    {
+        const std::size_t index = static_cast<std::size_t>(visible[k]);
+        const bool isPlayer = index < playerCount;
+        const std::uint32_t id = isPlayer ? playerStates[index].id : botStates[index - playerCount].id;
+
+        if (baseline && (isPlayer ? findById(baseline->players, id) != nullptr : findById(baseline->bots, id) != nullptr))
+        {
+            used -= snapshotRemovalBits(id);
+        }
+
+        // Our own player (health, and later corrections) is never deferred.
+        if (isPlayer && id == client.playerId)
+        {
+            scheduled[k] = 1;
+            used += cost(index);
+            continue;
+        }
+
+        const Vector2 pos = isPlayer ? playerStates[index].position : botStates[index - playerCount].position;
+        const float distance = sqrtf((pos.x - center.x) * (pos.x - center.x) + (pos.y - center.y) * (pos.y - center.y));
+        const float closeness = 1.0f - std::min(distance / (VIEW_HALF_WIDTH + VIEW_MARGIN), 1.0f);
+
+        Interest& interest = client.interest[id];
+        interest.priority += (isPlayer ? PLAYER_PRIORITY : BOT_PRIORITY) * (1.0f + closeness);
+        interest.seenTick = tick;
+        candidates.push_back({ interest.priority, k });
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    for (const int k : candidates | std::views::values)
+    {
+        const std::size_t index = static_cast<std::size_t>(visible[k]);
+        const std::size_t bits = cost(index);
+        if (used + bits > budgetBits)
+        {
+            continue;
+        }
+
+        used += bits;
+        scheduled[k] = 1;
+        const std::uint32_t id = index < playerCount ? playerStates[index].id : botStates[index - playerCount].id;
+        client.interest[id].priority = 0.0f;
+    }
+
+    // Forget actors that left the view; they start from zero on return.
+    std::erase_if(client.interest, [tick](const auto& entry) { return entry.second.seenTick != tick; });
+}
+
+void MatchRoom::SendSnapshots()
+{
+    PROFILE_SCOPE("Snapshots");
+
+    const auto& players = world.Players();
+    const auto& bots = world.Bots();
+    const std::size_t playerCount = players.size();
+    const std::uint32_t tick = world.TickCount();
+
+    actorGrid.Clear();
+    for (const auto& player : players) actorGrid.Add(player.position);
+    for (const auto& bot : bots) actorGrid.Add(bot.position);
+    actorGrid.Build();
+
+    // Every client gets the same state for an actor it is sent.
+    playerStates.clear();
+    for (const auto& player : players)
+    {
+        playerStates.push_back({
+            player.id, player.position, VelocityOf(player.position, player.previousPosition, step),
+            HealthByte(player.health)
+        });
+    }
+    botStates.clear();
+    for (const auto& bot : bots)
+    {
+        botStates.push_back({
+            bot.id, bot.position, VelocityOf(bot.position, bot.previousPosition, step),
+            HealthByte(bot.health), static_cast<std::uint8_t>(bot.GetState())
+        });
+    }
+
+    const std::size_t budget = std::min(
+        static_cast<std::size_t>(static_cast<float>(CLIENT_BANDWIDTH * SNAPSHOT_INTERVAL_TICKS) / tickRate),
+        OutgoingQueue::MAX_DATAGRAM_SIZE);
+
+    for (auto& [peer, client] : clients)
+    {
+        actorGrid.Query(client.view, visible);
+
+        outbound.clear();
+        SnapshotMsg& header = outbound.snapshots.emplace_back();
+        header.tick = tick;
+        header.baseTick = client.ackedSnapshot;
+        header.ackedInput = client.lastApplied;
+        if (const Player* own = world.FindPlayer(client.playerId))
+        {
+            header.playerSpeed = own->speed;
+            header.playerCanJump = own->canJump;
+        }
+
+        const SnapshotHistory::Entry* baseline = client.sent.find(client.ackedSnapshot);
+        ScheduleActors(client, baseline, header, budget);
+
+        // Deferred actors repeat their baseline state, which costs nothing
+        // in the delta and which the client knows not to interpolate to;
+        // ones the client has never seen wait to be sent.
+        // Visible indices ascend, so both lists stay in id order.
+        for (std::size_t k = 0; k < visible.size(); ++k)
+        {
+            const std::size_t index = static_cast<std::size_t>(visible[k]);
+            if (index < playerCount)
+            {
+                const PlayerStateMsg& state = playerStates[index];
+                if (scheduled[k])
+                {
+                    outbound.players.push_back(state);
+                }
+                else if (const PlayerStateMsg* old = baseline ? findById(baseline->players, state.id) : nullptr)
+                {
+                    outbound.players.push_back(*old);
+                }
+            }
+            else
+            {
+                const BotStateMsg& state = botStates[index - playerCount];
+                if (scheduled[k])
+                {
+                    outbound.bots.push_back(state);
+                }
+                else if (const BotStateMsg* old = baseline ? findById(baseline->bots, state.id) : nullptr)
+                {
+                    outbound.bots.push_back(*old);
+                }
+            }
+        }
+
+        writer.clear();
+        encodePacket(outbound, writer, &client.sent);
+        net.send(peer, writer.data(), Channel::State);
+        client.sent.store(tick, outbound.players, outbound.bots);
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "World.h"
+#include "Metrics.h"
+#include "InterestGrid.h"
+#include "NetworkServer.h"
+#include "Protocol.h"
+
+// One authoritative match: a World with no window, fed the input commands
+// of the clients on one network shard, sending each of them snapshots and
+// shot/hit events for the part of the map it can see. GameServer decides
+// when each room ticks and on which thread.
+class MatchRoom
+{
+public:
+    // Written by whichever worker ticks the room, readable from any thread.
+    struct Metrics
+    {
+        // Microseconds spent in Tick(), and how far past its due time the
+        // tick started: either growing towards the step means overload.
+        Histogram tickUs;
+        Histogram lateUs;
+        Gauge clients;
+        Gauge players;
+        Gauge bots;
+        Gauge projectiles;
+        // Inputs received ahead of the tick that will apply them.
+        Gauge pendingInputs;
+    };
+
+    MatchRoom(NetworkServer::Shard& net, float tickRate);
+
+    void Tick();
+
+    [[nodiscard]] float Step() const { return step; }
+    [[nodiscard]] Metrics& GetMetrics() { return metrics; }
+
+    static constexpr int SNAPSHOT_INTERVAL_TICKS = 2;
+    static constexpr std::size_t MAX_PENDING_INPUTS = 8;
+
+    // A client hears about actors inside the largest area its camera can
+    // show (1800x900 at the 0.7 minimum zoom), plus a margin so they are
+    // known before they scroll into sight.
+    static constexpr float VIEW_HALF_WIDTH = 1300.0f;
+    static constexpr float VIEW_HALF_HEIGHT = 650.0f;
+    static constexpr float VIEW_MARGIN = 300.0f;
+
+    // Snapshot bytes per second per client. When the actors in view need
+    // more, the ones waiting longest (weighted by closeness) go first and
+    // the rest keep their last sent state until their turn.
+    static constexpr std::size_t CLIENT_BANDWIDTH = 16 * 1024;
+
+    // Oldest moment a shot may be resolved against; clients further behind
+    // than this get their hits tested at the window's edge.
+    static constexpr float LAG_COMPENSATION_WINDOW = 0.5f;
+
+private:
+    struct Interest
+    {
+        float priority = 0.0f;
+        std::uint32_t seenTick = 0;
+    };
+
+    struct Client
+    {
+        std::uint32_t playerId = 0;
+        std::uint32_t lastReceived = 0;
+        std::uint32_t lastApplied = 0;
+        std::deque<InputMsg> pending;
+
+        // Snapshots sent to this client and the newest one it acknowledged,
+        // the baseline the next snapshot is delta-coded against.
+        SnapshotHistory sent;
+        std::uint32_t ackedSnapshot = 0;
+
+        Rectangle view{};
+        // Per actor in view: priority accumulated since it was last sent.
+        std::unordered_map<std::uint32_t, Interest> interest;
+    };
+
+    void OnEvent(NetworkServer::EventType type, std::uint32_t peer, const std::uint8_t* data, std::size_t size);
+    void ApplyInputs();
+    void UpdateViews();
+    void SendEvents();
+    void SendSnapshots();
+    void ScheduleActors(Client& client, const SnapshotHistory::Entry* baseline, const SnapshotMsg& header,
+                        std::size_t budget);
+
+    World world;
+    NetworkServer::Shard& net;
+    float tickRate;
+    float step;
+
+    std::unordered_map<std::uint32_t, Client> clients;
+    std::uint32_t spawnCursor = 0;
+
+    Metrics metrics;
+
+    Packet inbound;
+    Packet outbound;
+    BitWriter writer;
+
+    // Scratch for SendSnapshots: indices into players then bots, and their
+    // states this tick.
+    InterestGrid actorGrid;
+    std::vector<PlayerStateMsg> playerStates;
+    std::vector<BotStateMsg> botStates;
+    std::vector<int> visible;
+    std::vector<std::pair<float, int>> candidates;
+    std::vector<char> scheduled;
+};
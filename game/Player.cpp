@@ -1,5 +1,6 @@
 #include "Player.h"
-#include "Game.h"
+#include "EnvIndex.h"
+#include "ShapeBatch.h"
 #include "raylib.h"
 
 #include <cmath>
@@ -9,27 +10,29 @@
 #define PLAYER_HOR_SPD 400.0f
 
 Player::Player()
-	: position{100.0f, 500.0f}, speed(0.0f), canJump(false)
+	: position{100.0f, 500.0f}, previousPosition{100.0f, 500.0f}, speed(0.0f), canJump(false)
 {
 	health = 100;
 	maxHealth = 100;
 }
 
-void Player::Update(const float delta, const std::vector<EnvItem>& envItems)
+Rectangle Player::GetRect() const
 {
 	constexpr float halfWidth = 10.0f;
 	constexpr float fullHeight = 60.0f;
+	return { position.x - halfWidth, position.y - fullHeight, halfWidth * 2.0f, fullHeight };
+}
 
-	if (IsKeyDown(KEY_A))
-	{
-		position.x -= PLAYER_HOR_SPD * delta;
-	}
-	if (IsKeyDown(KEY_D))
-	{
-		position.x += PLAYER_HOR_SPD * delta;
-	}
+void Player::Update(const float delta, const InputCommand& cmd, const EnvIndex& env)
+{
+	constexpr float halfWidth = 10.0f;
+	constexpr float fullHeight = 60.0f;
+
+	previousPosition = position;
 
-	if (IsKeyPressed(KEY_W) && canJump)
+	position.x += fmaxf(-1.0f, fminf(cmd.moveX, 1.0f)) * PLAYER_HOR_SPD * delta;
+
+	if (cmd.jump && canJump)
 	{
 		speed = -PLAYER_JUMP_SPD;
 		canJump = false;
@@ -47,14 +50,14 @@ void Player::Update(const float delta, const std::vector<EnvItem>& envItems)
 
 	bool grounded = false;
 
-	for (const auto &[rect, blocking, color] : envItems)
-	{
-		if (!blocking)
-		{
-			continue;
-		}
+	// Resolution pushes by at most one overlap, so a margin of the body size covers every contact.
+	static thread_local std::vector<int> candidates;
+	env.QueryRect({ playerRect.x - halfWidth * 2.0f, playerRect.y - fullHeight,
+		playerRect.width + halfWidth * 4.0f, playerRect.height + fullHeight * 2.0f }, candidates);
 
-		if (const Rectangle &rectangle = rect; CheckCollisionRecs(rectangle, playerRect))
+	for (const int index : candidates)
+	{
+		if (const Rectangle &rectangle = env.Item(index).rect; CheckCollisionRecs(rectangle, playerRect))
 		{
 			const float overlapLeft = playerRect.x + playerRect.width - rectangle.x;
 			const float overlapRight = rectangle.x + rectangle.width - playerRect.x;
@@ -95,26 +98,33 @@ void Player::Update(const float delta, const std::vector<EnvItem>& envItems)
 	canJump = grounded;
 }
 
-void Player::Draw()
+void Player::Draw(ShapeBatch &batch, const float alpha)
 {
 	constexpr float halfWidth = 10.0f;
 	constexpr float fullHeight = 60.0f;
 
-	const Rectangle playerRect = { position.x - halfWidth, position.y - fullHeight, halfWidth * 2.0f, fullHeight };
-	DrawRectangleRec(playerRect, RED);
+	const Vector2 renderPos = {
+		previousPosition.x + (position.x - previousPosition.x) * alpha + renderOffset.x,
+		previousPosition.y + (position.y - previousPosition.y) * alpha + renderOffset.y
+	};
+
+	const Rectangle playerRect = { renderPos.x - halfWidth, renderPos.y - fullHeight, halfWidth * 2.0f, fullHeight };
+	batch.AddRect(playerRect, RED);
 
 	// Health bar
 	const float barWidth = halfWidth * 2.0f;
 	const float barHeight = 5.0f;
 	const float gap = 6.0f;
-	const float barX = position.x - barWidth / 2.0f;
-	const float barY = position.y - fullHeight - gap - barHeight;
+	const float barX = renderPos.x - barWidth / 2.0f;
+	const float barY = renderPos.y - fullHeight - gap - barHeight;
 
 	// Background (dark)
-	DrawRectangleRec({ barX - 1.0f, barY - 1.0f, barWidth + 2.0f, barHeight + 2.0f }, DARKGRAY);
+	batch.AddRect({ barX - 1.0f, barY - 1.0f, barWidth + 2.0f, barHeight + 2.0f }, DARKGRAY);
 
 	// Foreground (red) proportional to health
 	float healthRatio = 0.0f;
 	if (maxHealth > 0) healthRatio = static_cast<float>(health) / static_cast<float>(maxHealth);
-	DrawRectangleRec({ barX, barY, barWidth * healthRatio, barHeight }, RED);
+	batch.AddRect({ barX, barY, barWidth * healthRatio, barHeight }, RED);
+
+	weapon.Draw(batch, Vector2{ renderPos.x - position.x, renderPos.y - position.y });
 }
@@ -2,15 +2,21 @@
 #include "raylib.h"
 #include <vector>
 #include "Weapon.h"
+#include "Input.h"
+#include <cstdint>
 
-struct EnvItem; 
+class EnvIndex;
+class ShapeBatch;
 
 class Player
 {
 public:
     Player();
 
+    std::uint32_t id = 0;
+
     Vector2 position;
+    Vector2 previousPosition;
     float speed;
     bool canJump;
 
@@ -18,9 +24,16 @@ public:
     int maxHealth;
 
     Weapon weapon;
+    InputCommand input{};
+
+    // Drawn on top of the interpolated position only; a networked client
+    // uses it to blend out prediction corrections instead of snapping.
+    Vector2 renderOffset{};
+
+    [[nodiscard]] Rectangle GetRect() const;
 
-    void Update(float delta, const std::vector<EnvItem>& envItems);
-    void Draw();
+    void Update(float delta, const InputCommand& cmd, const EnvIndex& env);
+    void Draw(ShapeBatch &batch, float alpha = 1.0f);
 };
 
 
@@ -0,0 +1,153 @@
+#include "ShapeBatch.h"
+#include "raylib.h"
+#include "rlgl.h"
+#include "Profiler.h"
+
+#include <cmath>
+
+ShapeBatch::ShapeBatch()
+{
+    for (int i = 0; i <= CIRCLE_SEGMENTS; ++i)
+    {
+        const float angle = 2.0f * PI * static_cast<float>(i) / static_cast<float>(CIRCLE_SEGMENTS);
+        unitCircle[i] = Vector2{ cosf(angle), sinf(angle) };
+    }
+
+    vertices.reserve(1 << 16);
+}
+
+void ShapeBatch::Clear()
+{
+    vertices.clear();
+}
+
+void ShapeBatch::Push(const Vector2 a, const Vector2 b, const Vector2 c, const Color color)
+{
+    vertices.push_back({ a.x, a.y, color });
+    vertices.push_back({ b.x, b.y, color });
+    vertices.push_back({ c.x, c.y, color });
+}
+
+void ShapeBatch::AddTriangle(const Vector2 a, const Vector2 b, const Vector2 c, const Color color)
+{
+    // rlgl culls back faces, so normalize to raylib's counter-clockwise (y-down) winding.
+    const float cross = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (cross > 0.0f)
+    {
+        Push(a, c, b, color);
+    }
+    else
+    {
+        Push(a, b, c, color);
+    }
+}
+
+void ShapeBatch::AddRect(const Rectangle &rect, const Color color)
+{
+    const Vector2 tl = { rect.x, rect.y };
+    const Vector2 tr = { rect.x + rect.width, rect.y };
+    const Vector2 bl = { rect.x, rect.y + rect.height };
+    const Vector2 br = { rect.x + rect.width, rect.y + rect.height };
+
+    Push(tl, bl, br, color);
+    Push(tl, br, tr, color);
+}
+
+void ShapeBatch::AddRectPro(const Rectangle &rect, const Vector2 origin, const float rotationDegrees, const Color color)
+{
+    if (rotationDegrees == 0.0f)
+    {
+        AddRect({ rect.x - origin.x, rect.y - origin.y, rect.width, rect.height }, color);
+        return;
+    }
+
+    const float s = sinf(rotationDegrees * DEG2RAD);
+    const float c = cosf(rotationDegrees * DEG2RAD);
+    const float dx = -origin.x;
+    const float dy = -origin.y;
+
+    const Vector2 tl = { rect.x + dx * c - dy * s, rect.y + dx * s + dy * c };
+    const Vector2 tr = { rect.x + (dx + rect.width) * c - dy * s, rect.y + (dx + rect.width) * s + dy * c };
+    const Vector2 bl = { rect.x + dx * c - (dy + rect.height) * s, rect.y + dx * s + (dy + rect.height) * c };
+    const Vector2 br = { rect.x + (dx + rect.width) * c - (dy + rect.height) * s,
+                         rect.y + (dx + rect.width) * s + (dy + rect.height) * c };
+
+    Push(tl, bl, br, color);
+    Push(tl, br, tr, color);
+}
+
+void ShapeBatch::AddCircle(const Vector2 center, const float radius, const Color color)
+{
+    // Particles are a few pixels wide; half the segments is indistinguishable there.
+    const int step = radius < SMALL_CIRCLE_RADIUS ? 2 : 1;
+
+    for (int i = 0; i < CIRCLE_SEGMENTS; i += step)
+    {
+        const Vector2 &a = unitCircle[i];
+        const Vector2 &b = unitCircle[i + step];
+        Push(center,
+             { center.x + b.x * radius, center.y + b.y * radius },
+             { center.x + a.x * radius, center.y + a.y * radius },
+             color);
+    }
+}
+
+void ShapeBatch::AddLine(const Vector2 a, const Vector2 b, const float thickness, const Color color)
+{
+    const float dx = b.x - a.x;
+    const float dy = b.y - a.y;
+    const float len = sqrtf(dx * dx + dy * dy);
+    if (len < 1e-4f)
+    {
+        return;
+    }
+
+    const float nx = -dy / len * thickness * 0.5f;
+    const float ny =  dx / len * thickness * 0.5f;
+
+    const Vector2 p0 = { a.x + nx, a.y + ny };
+    const Vector2 p1 = { a.x - nx, a.y - ny };
+    const Vector2 p2 = { b.x - nx, b.y - ny };
+    const Vector2 p3 = { b.x + nx, b.y + ny };
+
+    AddTriangle(p0, p1, p2, color);
+    AddTriangle(p0, p2, p3, color);
+}
+
+void ShapeBatch::Flush()
+{
+    PROFILE_SCOPE("ShapeBatch::Flush");
+
+    if (vertices.empty())
+    {
+        return;
+    }
+
+    // Sample the white texel of raylib's shapes texture so we share its batch state.
+    const Texture2D texture = GetShapesTexture();
+    const Rectangle source = GetShapesTextureRectangle();
+    const float u = (source.x + source.width * 0.5f) / static_cast<float>(texture.width);
+    const float v = (source.y + source.height * 0.5f) / static_cast<float>(texture.height);
+
+    constexpr std::size_t CHUNK = 3 * 1024;
+
+    rlSetTexture(texture.id);
+    for (std::size_t start = 0; start < vertices.size(); start += CHUNK)
+    {
+        const std::size_t end = start + CHUNK < vertices.size() ? start + CHUNK : vertices.size();
+        rlCheckRenderBatchLimit(static_cast<int>(end - start));
+
+        rlBegin(RL_TRIANGLES);
+        for (std::size_t i = start; i < end; ++i)
+        {
+            const Vertex &vertex = vertices[i];
+            rlColor4ub(vertex.color.r, vertex.color.g, vertex.color.b, vertex.color.a);
+            rlTexCoord2f(u, v);
+            rlVertex2f(vertex.x, vertex.y);
+        }
+        rlEnd();
+    }
+    rlSetTexture(0);
+
+    vertices.clear();
+}
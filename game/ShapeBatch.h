@@ -0,0 +1,43 @@
+#pragma once
+
+#include "raylib.h"
+#include <vector>
+#include <cstddef>
+
+// Collects world-space primitives as colored triangles and submits them to
+// rlgl in one pass, so a frame costs a handful of draw calls instead of one
+// raylib call per circle or rectangle.
+class ShapeBatch
+{
+public:
+    ShapeBatch();
+
+    void Clear();
+
+    void AddTriangle(Vector2 a, Vector2 b, Vector2 c, Color color);
+    void AddRect(const Rectangle &rect, Color color);
+    void AddRectPro(const Rectangle &rect, Vector2 origin, float rotationDegrees, Color color);
+    void AddCircle(Vector2 center, float radius, Color color);
+    void AddLine(Vector2 a, Vector2 b, float thickness, Color color);
+
+    // Submits everything collected since the last Clear and clears the batch.
+    void Flush();
+
+    [[nodiscard]] std::size_t VertexCount() const { return vertices.size(); }
+
+private:
+    struct Vertex
+    {
+        float x;
+        float y;
+        Color color;
+    };
+
+    void Push(Vector2 a, Vector2 b, Vector2 c, Color color);
+
+    static constexpr int CIRCLE_SEGMENTS = 16;
+    static constexpr float SMALL_CIRCLE_RADIUS = 4.0f;
+
+    Vector2 unitCircle[CIRCLE_SEGMENTS + 1]{};
+    std::vector<Vertex> vertices;
+};
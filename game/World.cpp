@@ -0,0 +1,212 @@
+#include "World.h"
+#include "raylib.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+World::World(const std::size_t particleCapacity)
+    : particles(particleCapacity) {}
+
+void World::InitScene()
+{
+    LoadLevel({
+        EnvItem{ { 0,    0,   2000,   10  },     1, GRAY },
+        EnvItem{ { 0,    0,   10,     700 },     1, GRAY },
+        EnvItem{ { 1990, 0,   10,     700 },     1, GRAY },
+        EnvItem{ { 0,    690, 2000,   10  },     1, GRAY },
+
+        EnvItem{ { 0,   300, 400, 50 } ,1, GRAY },
+        EnvItem{ { 350, 500, 400, 50 } ,1, GRAY },
+        EnvItem{ { 600, 130, 250, 50 } ,1, GRAY },
+
+        EnvItem{ { 1150, 500, 400, 50 } ,1, GRAY },
+        EnvItem{ { 1600, 300, 400, 50 } ,1, GRAY },
+        EnvItem{ { 1050, 160, 300, 50 } ,1, GRAY },
+
+        EnvItem{ { 500,  640, 200, 50 }, 1,  GRAY },
+        EnvItem{ { 1200, 640, 200, 50 }, 1,  GRAY },
+
+        EnvItem{ { 850, 10, 200, 350 }, 1, GRAY},
+    });
+
+    players.clear();
+
+    bots.clear();
+    AddBot({ 1800.0f, 500.0f }, 0.2f, 0.3f);
+    AddBot({ 1200.0f, 400.0f }, 0.6f, 0.7f);
+    AddBot({  700.0f, 100.0f }, 1.0f, 1.0f);
+
+    projectiles.Clear();
+    particles.Clear();
+    hitHistory.Clear();
+    tick = 0;
+}
+
+void World::LoadLevel(std::vector<EnvItem> items, const EnvIndex::Mode mode)
+{
+    envItems = std::move(items);
+    envIndex.Build(envItems, mode);
+}
+
+std::uint32_t World::AddBot(const Vector2 spawn, const float difficulty, const float aggression)
+{
+    Bot& bot = bots.emplace_back(spawn, difficulty, aggression);
+    bot.id = nextActorId++;
+    bot.weapon.SetOwner(bot.id, BOT_TEAM, static_cast<int>(10 * bot.damageMultiplier));
+    return bot.id;
+}
+
+std::uint32_t World::AddPlayer(const Vector2 spawn)
+{
+    Player& player = players.emplace_back();
+    player.id = nextActorId++;
+    player.position = spawn;
+    player.previousPosition = spawn;
+    player.weapon.SetOwner(player.id, PLAYER_TEAM, PLAYER_BULLET_DAMAGE);
+    return player.id;
+}
+
+void World::RemovePlayer(const std::uint32_t id)
+{
+    std::erase_if(players, [id](const Player& p) { return p.id == id; });
+}
+
+Player* World::FindPlayer(const std::uint32_t id)
+{
+    for (auto& player : players)
+    {
+        if (player.id == id) return &player;
+    }
+    return nullptr;
+}
+
+const Player* World::FindPlayer(const std::uint32_t id) const
+{
+    for (const auto& player : players)
+    {
+        if (player.id == id) return &player;
+    }
+    return nullptr;
+}
+
+Bot* World::FindBot(const std::uint32_t id)
+{
+    for (auto& bot : bots)
+    {
+        if (bot.id == id) return &bot;
+    }
+    return nullptr;
+}
+
+void World::SetLagCompensation(const float seconds)
+{
+    lagCompensation = seconds > 0.0f ? seconds : 0.0f;
+    hitHistory.Clear();
+}
+
+void World::SetInput(const std::uint32_t playerId, const InputCommand& cmd)
+{
+    if (Player* player = FindPlayer(playerId))
+    {
+        player->input = cmd;
+    }
+}
+
+void World::Tick(const float delta)
+{
+    PROFILE_SCOPE("World::Tick");
+    ++tick;
+    projectiles.ClearSpawnLog();
+
+    {
+        PROFILE_SCOPE("Player physics");
+        for (auto& player : players)
+        {
+            player.Update(delta, player.input, envIndex);
+        }
+    }
+
+    if (authoritative)
+    {
+        PROFILE_SCOPE("Bot AI");
+        for (auto& bot : bots)
+        {
+            // Bots hunt whichever player is closest; with nobody around they just wander.
+            Vector2 target = { 1e9f, 1e9f };
+            float bestDist = 1e30f;
+            for (const auto& player : players)
+            {
+                const float dx = player.position.x - bot.position.x;
+                const float dy = player.position.y - bot.position.y;
+                if (const float d = dx * dx + dy * dy; d < bestDist)
+                {
+                    bestDist = d;
+                    target = player.position;
+                }
+            }
+
+            bot.Update(delta, envIndex, target, projectiles);
+        }
+    }
+
+    const bool compensate = authoritative && lagCompensation > 0.0f;
+    if (compensate)
+    {
+        // One frame per tick of the window, plus the present one.
+        hitHistory.SetCapacity(static_cast<std::size_t>(ceilf(lagCompensation / delta)) + 1);
+    }
+
+    for (auto& player : players)
+    {
+        // The shooter saw the tick in viewTick; the bullet is tested
+        // against that moment for as long as it flies.
+        std::uint16_t rewind = 0;
+        if (compensate && player.input.viewTick != 0 && player.input.viewTick < tick)
+        {
+            rewind = static_cast<std::uint16_t>(std::min<std::size_t>(tick - player.input.viewTick, hitHistory.Capacity() - 1));
+        }
+
+        const Vector2 weaponAnchor = { player.position.x, player.position.y - 35.0f };
+        player.weapon.Update(delta, weaponAnchor, player.input.aim, projectiles, player.input.spread, player.input.fire, rewind);
+        player.input.jump = false;
+    }
+
+    hitTargets.clear();
+    for (const auto& player : players)
+    {
+        hitTargets.push_back({ player.id, PLAYER_TEAM, player.GetRect() });
+    }
+    for (const auto& bot : bots)
+    {
+        if (bot.IsDead()) continue;
+        hitTargets.push_back({ bot.id, BOT_TEAM, bot.GetRect() });
+    }
+
+    hits.clear();
+    {
+        PROFILE_SCOPE("Projectiles + hits");
+        if (compensate)
+        {
+            hitHistory.Store(hitTargets);
+        }
+        projectiles.Update(delta, envIndex, hitTargets, particles, hits, compensate ? &hitHistory : nullptr);
+    }
+
+    for (const auto& hit : hits)
+    {
+        if (!authoritative) break;
+
+        int* health = nullptr;
+        if (Player* player = FindPlayer(hit.targetId)) health = &player->health;
+        else if (Bot* bot = FindBot(hit.targetId)) health = &bot->health;
+        if (!health) continue;
+
+        *health -= hit.damage;
+        if (*health < 0) *health = 0;
+    }
+
+    PROFILE_SCOPE("Particles");
+    particles.Update(delta);
+}
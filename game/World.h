@@ -0,0 +1,85 @@
+#pragma once
+
+#include "raylib.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "EnvIndex.h"
+#include "Input.h"
+#include "Player.h"
+#include "Bot.h"
+#include "ParticleSystem.h"
+#include "ProjectileSystem.h"
+#include "HitboxHistory.h"
+
+// Complete simulation state of one match with no window, input device or
+// renderer attached. Game drives one from the local keyboard; headless runs
+// drive it from scripted input.
+class World
+{
+public:
+    explicit World(std::size_t particleCapacity = 16384);
+
+    void InitScene();
+
+    // Replaces the level geometry; actors and projectiles are left alone.
+    void LoadLevel(std::vector<EnvItem> items, EnvIndex::Mode mode = EnvIndex::Mode::Grid);
+
+    std::uint32_t AddBot(Vector2 spawn, float difficulty = 0.5f, float aggression = 0.5f);
+
+    std::uint32_t AddPlayer(Vector2 spawn);
+    void RemovePlayer(std::uint32_t id);
+    [[nodiscard]] Player* FindPlayer(std::uint32_t id);
+    [[nodiscard]] const Player* FindPlayer(std::uint32_t id) const;
+    [[nodiscard]] Bot* FindBot(std::uint32_t id);
+
+    // Command applied to the player on the next Tick.
+    void SetInput(std::uint32_t playerId, const InputCommand& cmd);
+
+    void Tick(float delta);
+
+    // A non-authoritative world (a client of a game server) runs no bot AI
+    // and applies no damage; both arrive from the server instead.
+    void SetAuthoritative(bool value) { authoritative = value; }
+    [[nodiscard]] bool IsAuthoritative() const { return authoritative; }
+
+    // Keeps `seconds` of hitbox history so player shots are resolved
+    // against the tick named in their input's viewTick; 0 turns it off.
+    void SetLagCompensation(float seconds);
+
+    [[nodiscard]] const std::vector<EnvItem>& EnvItems() const { return envItems; }
+    [[nodiscard]] const EnvIndex& Env() const { return envIndex; }
+    [[nodiscard]] std::vector<Player>& Players() { return players; }
+    [[nodiscard]] const std::vector<Player>& Players() const { return players; }
+    [[nodiscard]] std::vector<Bot>& Bots() { return bots; }
+    [[nodiscard]] const std::vector<Bot>& Bots() const { return bots; }
+    [[nodiscard]] ProjectileSystem& Projectiles() { return projectiles; }
+    [[nodiscard]] const ProjectileSystem& Projectiles() const { return projectiles; }
+    [[nodiscard]] ParticleSystem& Particles() { return particles; }
+    [[nodiscard]] const ParticleSystem& Particles() const { return particles; }
+    [[nodiscard]] const std::vector<ProjectileHit>& LastHits() const { return hits; }
+    [[nodiscard]] std::uint32_t TickCount() const { return tick; }
+
+    static constexpr std::uint8_t PLAYER_TEAM = 0;
+    static constexpr std::uint8_t BOT_TEAM = 1;
+    static constexpr int PLAYER_BULLET_DAMAGE = 10;
+
+private:
+    std::vector<EnvItem> envItems;
+    EnvIndex envIndex;
+
+    std::vector<Player> players;
+    std::vector<Bot> bots;
+
+    ParticleSystem particles;
+    ProjectileSystem projectiles;
+    std::vector<HitTarget> hitTargets;
+    std::vector<ProjectileHit> hits;
+    HitboxHistory hitHistory;
+    float lagCompensation = 0.0f;
+
+    std::uint32_t nextActorId = 1;
+    std::uint32_t tick = 0;
+    bool authoritative = true;
+};
@@ -1,9 +1,16 @@
 #include "raylib.h"
 #include "Game.h"
-#include "NetworkServer.h"
+#include "GameServer.h"
+#include "LoadTest.h"
 #include <string>
 #include <iostream>
+#include <chrono>
+#include <atomic>
+#include <thread>
 #include "NetworkClient.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "Protocol.h"
 
 int main(int argc, char** argv)
 {
@@ -14,6 +21,91 @@ int main(int argc, char** argv)
         std::cout << "  argv[" << i << "] = " << argv[i] << "\n";
     }
     std::cout.flush();
+
+    float tickRate = 60.0f;
+    float interpDelayMs = 50.0f;
+    std::size_t rooms = 1;
+    std::size_t roomCapacity = GameServer::MAX_CLIENTS_PER_ROOM;
+    std::size_t workers = 0;
+    int preferredRoom = -1;
+    std::string statsPath;
+    uint16_t statsPort = 0;
+    float statsInterval = 5.0f;
+    LoadTest::Options loadTest;
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--tick-rate")
+        {
+            tickRate = std::stof(argv[i + 1]);
+        }
+        else if (std::string(argv[i]) == "--interp-delay")
+        {
+            interpDelayMs = std::stof(argv[i + 1]);
+        }
+        else if (std::string(argv[i]) == "--rooms")
+        {
+            rooms = static_cast<std::size_t>(std::stoul(argv[i + 1]));
+        }
+        else if (std::string(argv[i]) == "--room-capacity")
+        {
+            roomCapacity = static_cast<std::size_t>(std::stoul(argv[i + 1]));
+        }
+        else if (std::string(argv[i]) == "--workers")
+        {
+            workers = static_cast<std::size_t>(std::stoul(argv[i + 1]));
+        }
+        else if (std::string(argv[i]) == "--room")
+        {
+            preferredRoom = std::stoi(argv[i + 1]);
+        }
+        else if (std::string(argv[i]) == "--stats-file")
+        {
+            statsPath = argv[i + 1];
+        }
+        else if (std::string(argv[i]) == "--stats-port")
+        {
+            statsPort = static_cast<uint16_t>(std::stoi(argv[i + 1]));
+        }
+        else if (std::string(argv[i]) == "--stats-interval")
+        {
+            statsInterval = std::stof(argv[i + 1]);
+        }
+        else if (std::string(argv[i]) == "--clients")
+        {
+            loadTest.clients = static_cast<std::size_t>(std::stoul(argv[i + 1]));
+        }
+        else if (std::string(argv[i]) == "--threads")
+        {
+            loadTest.threads = static_cast<std::size_t>(std::stoul(argv[i + 1]));
+        }
+        else if (std::string(argv[i]) == "--duration")
+        {
+            loadTest.seconds = std::stof(argv[i + 1]);
+        }
+        else if (std::string(argv[i]) == "--ramp")
+        {
+            loadTest.rampSeconds = std::stof(argv[i + 1]);
+        }
+        else if (std::string(argv[i]) == "--log-level")
+        {
+            LogLevel level;
+            if (Log::ParseLevel(argv[i + 1], level))
+            {
+                Log::SetLevel(level);
+            }
+            else
+            {
+                std::cerr << "Unknown log level " << argv[i + 1] << ", expected debug, info, warn or error\n";
+            }
+        }
+        else if (std::string(argv[i]) == "--log-file")
+        {
+            if (!Log::Get().SetFile(argv[i + 1]))
+            {
+                std::cerr << "Could not open log file " << argv[i + 1] << "\n";
+            }
+        }
+    }
     
     if (argc > 1)
     {
@@ -25,7 +117,7 @@ int main(int argc, char** argv)
         if (mode == "server")
         {
             uint16_t port = 1234;
-            if (argc > 2)
+            if (argc > 2 && argv[2][0] != '-')
             {
                 port = static_cast<uint16_t>(std::stoi(argv[2]));
             }
@@ -33,24 +125,88 @@ int main(int argc, char** argv)
             std::cout << "Starting server on port " << port << "...\n";
             std::cout.flush();
 
-            NetworkServer server(port);
-            if (!server.start())
+            GameServer server(port, tickRate, rooms, workers, roomCapacity);
+            server.SetStatsOutput(statsPath, statsPort, statsInterval);
+            if (!server.Start())
             {
+                Log::Get().Flush();
                 std::cerr << "Failed to start server\n";
                 std::cerr.flush();
                 return 1;
             }
 
-            std::cout << "Server running on port " << port << ". Press ENTER to stop.\n";
+            // Keeps the startup log above the prompt.
+            Log::Get().Flush();
+            std::cout << "Server running on port " << port << ": " << server.RoomCount() << " room(s) of "
+                      << server.RoomCapacity() << " at " << tickRate << " Hz on " << server.WorkerCount()
+                      << " worker(s). Press ENTER to stop.\n";
             std::cout.flush();
 
             std::string dummy;
             std::getline(std::cin, dummy);
 
-            server.stop();
+            server.Stop();
+            std::cout << "Server stopped after " << server.TickCount() << " room ticks\n";
             return 0;
         }
 
+        if (mode == "headless")
+        {
+            int ticks = 36000;
+            if (argc > 2 && argv[2][0] != '-')
+            {
+                ticks = std::stoi(argv[2]);
+            }
+
+            Game game(1800, 900, true);
+            game.SetTickRate(tickRate);
+
+            std::string tracePath;
+            for (int i = 2; i + 1 < argc; ++i)
+            {
+                if (std::string(argv[i]) == "--trace")
+                {
+                    tracePath = argv[i + 1];
+                }
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < ticks; ++i)
+            {
+                game.Simulate(1);
+                PROFILE_FRAME_END();
+            }
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            const World& world = game.GetWorld();
+            std::cout << "Simulated " << ticks << " ticks (" << static_cast<float>(ticks) / game.TickRate()
+                      << " s of game time) in " << seconds << " s, "
+                      << static_cast<double>(ticks) / seconds << " ticks/s\n";
+            std::cout << "Projectiles in flight: " << world.Projectiles().Count()
+                      << ", live particles: " << world.Particles().Count() << "\n";
+
+            if (!tracePath.empty() && !Profiler::Get().ExportChromeTrace(tracePath))
+            {
+                std::cerr << "Failed to write trace to " << tracePath << "\n";
+            }
+            return 0;
+        }
+
+        if (mode == "loadtest")
+        {
+            if (argc > 2 && argv[2][0] != '-')
+            {
+                loadTest.host = argv[2];
+            }
+            if (argc > 3 && argv[3][0] != '-')
+            {
+                loadTest.port = static_cast<uint16_t>(std::stoi(argv[3]));
+            }
+
+            LoadTest test(loadTest);
+            return test.Run() ? 0 : 1;
+        }
+
         if (mode == "client")
         {
             std::string host = "127.0.0.1";
@@ -72,12 +228,48 @@ int main(int argc, char** argv)
                 return 1;
             }
 
-            client.setReceiveCallback([&](const std::vector<uint8_t>& data)
+            const auto printFrame = [](const uint8_t* data, const std::size_t size)
+            {
+                Packet packet;
+                if (!decodePacket(data, size, packet))
+                {
+                    const std::string s(data, data + size);
+                    std::cout << "Received: " << s << "\n";
+                    return;
+                }
+
+                for (const auto& m : packet.players)
+                {
+                    std::cout << "Player " << m.id << " at " << m.position.x << ", " << m.position.y
+                              << " hp " << static_cast<int>(m.health) << "\n";
+                }
+                for (const auto& m : packet.bots)
+                {
+                    std::cout << "Bot " << m.id << " at " << m.position.x << ", " << m.position.y
+                              << " hp " << static_cast<int>(m.health) << "\n";
+                }
+                for (const auto& m : packet.shots)
+                {
+                    std::cout << "Shot by " << m.ownerId << " from " << m.origin.x << ", " << m.origin.y << "\n";
+                }
+                for (const auto& m : packet.hits)
+                {
+                    std::cout << "Hit " << m.ownerId << " -> " << m.targetId << " for " << m.damage << "\n";
+                }
+            };
+
+            // stdin blocks this thread, so a second one drains the inbox.
+            std::atomic<bool> reading{ true };
+            std::thread printer([&]
             {
-                const std::string s(data.begin(), data.end());
-                std::cout << "Received: " << s << "\n";
+                while (reading)
+                {
+                    client.poll(printFrame);
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
             });
 
+            Log::Get().Flush();
             std::cout << "Connected to " << host << ":" << port << ". Type lines to send, empty line to quit." << std::endl;
             std::string line;
 
@@ -90,8 +282,11 @@ int main(int argc, char** argv)
 
                 std::vector<uint8_t> v(line.begin(), line.end());
                 client.send(v);
+                client.flush();
             }
 
+            reading = false;
+            printer.join();
             client.disconnect();
             return 0;
         }
@@ -105,6 +300,9 @@ int main(int argc, char** argv)
     SetTargetFPS(60);
 
     Game game(screenWidth, screenHeight);
+    game.SetTickRate(tickRate);
+    game.SetInterpolationDelay(interpDelayMs / 1000.0f);
+    game.SetPreferredRoom(preferredRoom);
 
     while (!WindowShouldClose())
     {
@@ -114,6 +312,8 @@ int main(int argc, char** argv)
 
         game.Update(deltaTime);
         game.Draw();
+
+        PROFILE_FRAME_END();
     }
 
     ShowCursor();
@@ -1,5 +1,6 @@
 #include "NetworkClient.h"
-#include <iostream>
+#include "Log.h"
+#include <optional>
 
 #include <enet/enet.h>
 
@@ -16,17 +17,18 @@ bool NetworkClient::connectTo(const std::string& host, const uint16_t port)
     {
         return true;
     }
+    disconnect();
 
     if (enet_initialize() != 0)
     {
-        std::cerr << "ENet initialization failed\n";
+        LOG_ERROR("[NetworkClient] ENet initialization failed");
         return false;
     }
 
-    client_ = enet_host_create(nullptr, 1, 2, 0, 0);
+    client_ = enet_host_create(nullptr, 1, CHANNEL_COUNT, 0, 0);
     if (!client_)
     {
-        std::cerr << "Failed to create ENet client host\n";
+        LOG_ERROR("[NetworkClient] Failed to create ENet client host");
         enet_deinitialize();
 
         return false;
@@ -36,10 +38,10 @@ bool NetworkClient::connectTo(const std::string& host, const uint16_t port)
     enet_address_set_host(&address, host.c_str());
     address.port = port;
 
-    peer_ = enet_host_connect(client_, &address, 2, 0);
+    peer_ = enet_host_connect(client_, &address, CHANNEL_COUNT, 0);
     if (!peer_)
     {
-        std::cerr << "No available peers for initiating an ENet connection\n";
+        LOG_ERROR("[NetworkClient] No available peers for initiating an ENet connection");
         enet_host_destroy(client_);
 
         client_ = nullptr;
@@ -50,12 +52,12 @@ bool NetworkClient::connectTo(const std::string& host, const uint16_t port)
     ENetEvent event;
     if (enet_host_service(client_, &event, 5000) > 0 && event.type == ENET_EVENT_TYPE_CONNECT)
     {
-        std::cout << "Connection to " << host << ":" << port << " succeeded.\n";
+        LOG_INFO("[NetworkClient] Connection to {}:{} succeeded", host, port);
     }
     else
     {
         enet_peer_reset(peer_);
-        std::cerr << "Connection to " << host << ":" << port << " failed.\n";
+        LOG_ERROR("[NetworkClient] Connection to {}:{} failed", host, port);
 
         enet_host_destroy(client_);
         client_ = nullptr;
@@ -63,6 +65,11 @@ bool NetworkClient::connectTo(const std::string& host, const uint16_t port)
         return false;
     }
 
+    if (!wakeup_.open())
+    {
+        LOG_WARN("[NetworkClient] Could not create a wakeup signal; sends wait for the service timeout");
+    }
+
     running_ = true;
     thread_ = std::thread(&NetworkClient::serviceLoop, this);
     return true;
@@ -70,26 +77,36 @@ bool NetworkClient::connectTo(const std::string& host, const uint16_t port)
 
 void NetworkClient::disconnect()
 {
-    if (!running_)
+    // The service thread clears running_ itself when the server drops us,
+    // so the host is what says whether there is anything to tear down.
+    if (!client_)
     {
         return;
     }
 
     running_ = false;
+    wakeup_.signal();
     if (thread_.joinable())
     {
         thread_.join();
     }
+    wakeup_.close();
     if (client_)
     {
         if (peer_)
         {
+            flush();
+            sendOutgoing();
             enet_peer_disconnect(peer_, 0);
             ENetEvent event;
 
             while (enet_host_service(client_, &event, 3000) > 0)
             {
-                if (event.type == ENET_EVENT_TYPE_DISCONNECT)
+                if (event.type == ENET_EVENT_TYPE_RECEIVE)
+                {
+                    enet_packet_destroy(event.packet);
+                }
+                else if (event.type == ENET_EVENT_TYPE_DISCONNECT)
                 {
                     break;
                 }
@@ -101,54 +118,99 @@ void NetworkClient::disconnect()
         enet_host_destroy(client_);
         client_ = nullptr;
     }
+
+    while (std::optional<ENetPacket*> packet = inbox_.TryPop())
+    {
+        enet_packet_destroy(*packet);
+    }
     enet_deinitialize();
 }
 
-void NetworkClient::send(const std::vector<uint8_t>& data) const
+void NetworkClient::send(const std::vector<uint8_t>& data, const Channel channel)
 {
-    if (!peer_)
+    outgoing_.push(0, channel, data.data(), data.size());
+}
+
+void NetworkClient::flush()
+{
+    outgoing_.seal();
+    wakeup_.signal();
+}
+
+// Runs on the service thread (or after it has stopped). The packets only
+// reach the socket on the next enet_host_service/flush, one syscall for all.
+void NetworkClient::sendOutgoing()
+{
+    outgoing_.drain(sending_);
+
+    for (auto& [peer, channel, bytes] : sending_)
     {
-        return;
+        const enet_uint32 flags = channel == Channel::State ? 0 : ENET_PACKET_FLAG_RELIABLE;
+        ENetPacket* packet = enet_packet_create(bytes.data(), bytes.size(), flags);
+        if (enet_peer_send(peer_, static_cast<enet_uint8>(channel), packet) < 0)
+        {
+            enet_packet_destroy(packet);
+        }
     }
-
-    ENetPacket* packet = enet_packet_create(data.data(), data.size(), ENET_PACKET_FLAG_RELIABLE);
-    enet_peer_send(peer_, 0, packet);
-    enet_host_flush(client_);
+    sending_.clear();
 }
 
-void NetworkClient::setReceiveCallback(std::function<void(const std::vector<uint8_t>&)> cb)
+std::size_t NetworkClient::poll(const FrameHandler& handler)
 {
-    callback_ = std::move(cb);
+    std::size_t frames = 0;
+    while (std::optional<ENetPacket*> packet = inbox_.TryPop())
+    {
+        forEachFrame((*packet)->data, (*packet)->dataLength,
+            [&](const uint8_t* data, const std::size_t size) {
+                handler(data, size);
+                ++frames;
+            });
+
+        enet_packet_destroy(*packet);
+    }
+    return frames;
 }
 
 void NetworkClient::serviceLoop()
 {
     while (running_)
     {
+        sendOutgoing();
+
+        // With no timeout this sends everything just queued, then takes in
+        // whatever has arrived until nothing is left.
         ENetEvent event;
-        while (enet_host_service(client_, &event, 100) > 0)
+        while (running_ && enet_host_service(client_, &event, 0) > 0)
         {
             switch (event.type)
             {
                 case ENET_EVENT_TYPE_RECEIVE:
                 {
-                    std::vector data(event.packet->data, event.packet->data + event.packet->dataLength);
-
-                    if (callback_)
+                    // Ownership moves to the game thread, which destroys it in poll().
+                    if (!inbox_.TryPush(event.packet))
                     {
-                        callback_(data);
+                        LOG_WARN("[NetworkClient] Game thread is behind; dropped a packet");
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                        enet_packet_destroy(event.packet);
                     }
-
-                    enet_packet_destroy(event.packet);
                     break;
                 }
                 case ENET_EVENT_TYPE_DISCONNECT:
-                    std::cout << "Disconnected from server\n";
+                    LOG_INFO("[NetworkClient] Disconnected from server");
+                    peer_ = nullptr;
                     running_ = false;
                     break;
                 default:
                     break;
             }
         }
+
+        if (running_)
+        {
+            // Until a datagram arrives, the game thread flushes or
+            // disconnect() is called; the timeout only keeps ENet's resend
+            // and ping timers going.
+            wakeup_.wait(client_, SERVICE_IDLE_MS);
+        }
     }
 }
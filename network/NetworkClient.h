@@ -6,8 +6,14 @@
 #include <functional>
 #include <string>
 
+#include "Protocol.h"
+#include "SpscQueue.h"
+#include "OutgoingQueue.h"
+#include "WakeupSignal.h"
+
 struct _ENetHost;
 struct _ENetPeer;
+struct _ENetPacket;
 
 class NetworkClient
 {
@@ -17,16 +23,43 @@ public:
 
     bool connectTo(const std::string& host, uint16_t port);
     void disconnect();
-    void send(const std::vector<uint8_t>& data) const;
-    void setReceiveCallback(std::function<void(const std::vector<uint8_t>&)> cb);
+
+    // Queues one message for the current batch. Nothing leaves the machine
+    // until flush(), which seals every channel's batch into one datagram
+    // (split only above OutgoingQueue::MAX_DATAGRAM_SIZE); the service
+    // thread sends them.
+    void send(const std::vector<uint8_t>& data, Channel channel = Channel::Events);
+    void flush();
+
+    using FrameHandler = std::function<void(const uint8_t* data, std::size_t size)>;
+
+    // Hands every frame received since the last call to `handler`, on the
+    // calling thread, then releases the packets. Frames point straight into
+    // ENet's packet memory and are only valid during the call. Meant to be
+    // called by one thread (the game thread) once per tick.
+    std::size_t poll(const FrameHandler& handler);
+
+    // Packets discarded because the game thread fell INBOX_CAPACITY behind.
+    [[nodiscard]] uint64_t droppedPackets() const { return dropped_.load(std::memory_order_relaxed); }
 
 private:
     void serviceLoop();
+    void sendOutgoing();
 
     struct _ENetHost* client_ = nullptr;
     struct _ENetPeer* peer_ = nullptr;
     std::thread thread_;
 
     std::atomic<bool> running_{false};
-    std::function<void(const std::vector<uint8_t>&)> callback_;
+
+    // Filled by the service thread, drained by poll().
+    static constexpr std::size_t INBOX_CAPACITY = 1024;
+    SpscQueue<struct _ENetPacket*, INBOX_CAPACITY> inbox_;
+    std::atomic<uint64_t> dropped_{0};
+
+    OutgoingQueue outgoing_;
+    std::vector<OutgoingQueue::Datagram> sending_;
+
+    WakeupSignal wakeup_;
+    static constexpr uint32_t SERVICE_IDLE_MS = 10;
 };
@@ -1,9 +1,21 @@
 #include <enet/enet.h>
 #include "NetworkServer.h"
-#include <iostream>
+#include "Protocol.h"
+#include "Log.h"
+#include <optional>
+#include <cstdint>
+#include <algorithm>
+#include <cstring>
 
-NetworkServer::NetworkServer(const uint16_t port)
-    : port_(port) {}
+NetworkServer::NetworkServer(const uint16_t port, const std::size_t maxPeers,
+                             const std::size_t shardCount, const std::size_t shardCapacity)
+    : port_(port), maxPeers_(maxPeers), shardCapacity_(shardCapacity)
+{
+    for (std::size_t i = 0; i < std::max<std::size_t>(shardCount, 1); ++i)
+    {
+        shards_.push_back(std::unique_ptr<Shard>(new Shard(*this, i)));
+    }
+}
 
 NetworkServer::~NetworkServer()
 {
@@ -12,56 +24,42 @@ NetworkServer::~NetworkServer()
 
 bool NetworkServer::start()
 {
-    std::cout << "[NetworkServer] Starting...\n";
-    std::cout.flush();
-    
     if (running_)
     {
-        std::cout << "[NetworkServer] Already running\n";
-        std::cout.flush();
+        LOG_DEBUG("[NetworkServer] Already running");
         return true;
     }
 
-    std::cout << "[NetworkServer] Initializing ENet...\n";
-    std::cout.flush();
-    
+    LOG_DEBUG("[NetworkServer] Initializing ENet");
     if (enet_initialize() != 0)
     {
-        std::cerr << "[NetworkServer] ERROR: ENet initialization failed\n";
-        std::cerr.flush();
+        LOG_ERROR("[NetworkServer] ENet initialization failed");
         return false;
     }
 
-    std::cout << "[NetworkServer] ENet initialized successfully\n";
-    std::cout.flush();
-
     ENetAddress address;
     address.host = ENET_HOST_ANY;
     address.port = port_;
 
-    std::cout << "[NetworkServer] Creating host on port " << port_ << "...\n";
-    std::cout.flush();
-
-    host_ = enet_host_create(&address, 32, 2, 0, 0);
+    host_ = enet_host_create(&address, maxPeers_, CHANNEL_COUNT, 0, 0);
 
     if (!host_)
     {
-        std::cerr << "[NetworkServer] ERROR: Failed to create ENet server host (port " << port_ << " may be in use)\n";
-        std::cerr.flush();
+        LOG_ERROR("[NetworkServer] Failed to create ENet server host (port {} may be in use)", port_);
         enet_deinitialize();
 
         return false;
     }
 
-    std::cout << "[NetworkServer] Host created successfully\n";
-    std::cout.flush();
+    if (!wakeup_.open())
+    {
+        LOG_WARN("[NetworkServer] Could not create a wakeup signal; sends wait for the service timeout");
+    }
 
     running_ = true;
     thread_ = std::thread(&NetworkServer::serviceLoop, this);
-    
-    std::cout << "[NetworkServer] Service thread started\n";
-    std::cout.flush();
-    
+
+    LOG_INFO("[NetworkServer] Listening on port {} for up to {} peers in {} room(s)", port_, maxPeers_, shards_.size());
     return true;
 }
 
@@ -73,55 +71,350 @@ void NetworkServer::stop()
     }
 
     running_ = false;
+    wakeup_.signal();
 
     if (thread_.joinable()) thread_.join();
+    wakeup_.close();
     if (host_)
     {
         enet_host_destroy(host_);
         host_ = nullptr;
     }
+    peers_.clear();
+    transfers_.clear();
+
+    for (const auto& shard : shards_)
+    {
+        while (std::optional<Event> event = shard->inbox_.TryPop())
+        {
+            if (event->packet) enet_packet_destroy(event->packet);
+        }
+        shard->population_.store(0, std::memory_order_relaxed);
+    }
     enet_deinitialize();
 }
 
-void NetworkServer::broadcast(const std::vector<uint8_t>& data) const
+uint64_t NetworkServer::droppedPackets() const
 {
-    if (!host_)
+    uint64_t total = 0;
+    for (const auto& shard : shards_)
+    {
+        total += shard->droppedPackets();
+    }
+    return total;
+}
+
+std::size_t NetworkServer::Shard::poll(const EventHandler& handler)
+{
+    std::size_t count = 0;
+    while (std::optional<Event> event = inbox_.TryPop())
+    {
+        ++count;
+        if (event->type != EventType::Receive)
+        {
+            handler(event->type, event->peer, nullptr, 0);
+            if (event->type == EventType::Disconnect)
+            {
+                outgoing_.forget(event->peer);
+            }
+            continue;
+        }
+
+        forEachFrame(event->packet->data, event->packet->dataLength,
+            [&](const uint8_t* data, const std::size_t size) {
+                handler(EventType::Receive, event->peer, data, size);
+            });
+        enet_packet_destroy(event->packet);
+    }
+    return count;
+}
+
+void NetworkServer::Shard::send(const uint32_t peer, const std::vector<uint8_t>& data, const Channel channel)
+{
+    outgoing_.push(peer, channel, data.data(), data.size());
+}
+
+void NetworkServer::Shard::broadcast(const std::vector<uint8_t>& data, const Channel channel)
+{
+    outgoing_.push(BROADCAST_PEER, channel, data.data(), data.size());
+}
+
+void NetworkServer::Shard::flush()
+{
+    outgoing_.seal();
+    server_.wakeup_.signal();
+}
+
+void NetworkServer::Shard::transfer(const uint32_t peer, const std::size_t to)
+{
+    {
+        std::lock_guard lock(server_.transferMutex_);
+        server_.transfers_.push_back({ peer, to });
+    }
+    server_.wakeup_.signal();
+}
+
+void NetworkServer::sendOutgoing(Shard& shard)
+{
+    shard.outgoing_.drain(sending_);
+
+    for (auto& [peer, channel, bytes] : sending_)
+    {
+        const enet_uint32 flags = channel == Channel::State ? 0 : ENET_PACKET_FLAG_RELIABLE;
+
+        if (peer == BROADCAST_PEER)
+        {
+            if (shards_.size() == 1)
+            {
+                enet_host_broadcast(host_, static_cast<enet_uint8>(channel),
+                                    enet_packet_create(bytes.data(), bytes.size(), flags));
+                for (auto& [id, entry] : peers_)
+                {
+                    ++entry.packetsOut;
+                    entry.bytesOut += bytes.size();
+                }
+                continue;
+            }
+
+            // ENet frees a shared packet once its last send completes, or
+            // right away if nobody took it.
+            ENetPacket* packet = enet_packet_create(bytes.data(), bytes.size(), flags);
+            for (auto& [id, entry] : peers_)
+            {
+                if (entry.shard == shard.index_)
+                {
+                    enet_peer_send(entry.peer, static_cast<enet_uint8>(channel), packet);
+                    ++entry.packetsOut;
+                    entry.bytesOut += bytes.size();
+                }
+            }
+            if (packet->referenceCount == 0)
+            {
+                enet_packet_destroy(packet);
+            }
+            continue;
+        }
+
+        // Batches still queued by a room the peer has since left are dropped.
+        const auto it = peers_.find(peer);
+        if (it == peers_.end() || it->second.shard != shard.index_)
+        {
+            continue;
+        }
+
+        ENetPacket* packet = enet_packet_create(bytes.data(), bytes.size(), flags);
+        if (enet_peer_send(it->second.peer, static_cast<enet_uint8>(channel), packet) < 0)
+        {
+            enet_packet_destroy(packet);
+            continue;
+        }
+        ++it->second.packetsOut;
+        it->second.bytesOut += bytes.size();
+    }
+}
+
+void NetworkServer::applyTransfers()
+{
+    {
+        std::lock_guard lock(transferMutex_);
+        applying_.swap(transfers_);
+    }
+
+    for (const auto& [peer, to] : applying_)
+    {
+        const auto it = peers_.find(peer);
+        if (it == peers_.end() || to >= shards_.size() || it->second.shard == to)
+        {
+            continue;
+        }
+
+        Shard& target = *shards_[to];
+        if (shardCapacity_ != 0 && target.population() >= shardCapacity_)
+        {
+            continue;
+        }
+
+        Shard& source = *shards_[it->second.shard];
+        source.population_.fetch_sub(1, std::memory_order_relaxed);
+        pushEvent(source, { EventType::Disconnect, peer, nullptr });
+
+        it->second.shard = to;
+        target.population_.fetch_add(1, std::memory_order_relaxed);
+        pushEvent(target, { EventType::Connect, peer, nullptr });
+    }
+    applying_.clear();
+}
+
+// Rooms fill one after another, so players meet others instead of being
+// spread thinly over every room.
+NetworkServer::Shard* NetworkServer::pickShard()
+{
+    if (shardCapacity_ == 0)
+    {
+        return shards_.front().get();
+    }
+
+    for (const auto& shard : shards_)
     {
+        if (shard->population() < shardCapacity_)
+        {
+            return shard.get();
+        }
+    }
+    return nullptr;
+}
+
+// Connects and disconnects must reach the simulation, so those wait for
+// room; received packets are dropped instead when the simulation lags.
+void NetworkServer::pushEvent(Shard& shard, const Event& event)
+{
+    if (event.type == EventType::Receive)
+    {
+        if (!shard.inbox_.TryPush(event))
+        {
+            LOG_WARN("[NetworkServer] Room {} is behind; dropped a packet from client {}", shard.index_, event.peer);
+            shard.dropped_.fetch_add(1, std::memory_order_relaxed);
+            enet_packet_destroy(event.packet);
+        }
         return;
     }
 
-    ENetPacket* packet = enet_packet_create(data.data(), data.size(), ENET_PACKET_FLAG_RELIABLE);
-    enet_host_broadcast(host_, 0, packet);
-    enet_host_flush(host_);
+    while (!shard.inbox_.TryPush(event) && running_)
+    {
+        std::this_thread::yield();
+    }
 }
 
-void NetworkServer::serviceLoop() const
+void NetworkServer::serviceLoop()
 {
     while (running_)
     {
+        applyTransfers();
+        for (const auto& shard : shards_)
+        {
+            sendOutgoing(*shard);
+        }
+
+        // With no timeout this sends everything just queued, then hands
+        // over whatever has arrived until nothing is left.
         ENetEvent event;
-        while (enet_host_service(host_, &event, 100) > 0)
+        while (running_ && enet_host_service(host_, &event, 0) > 0)
+        {
+            handleEvent(event);
+        }
+
+        if (std::chrono::steady_clock::now() >= nextStatsAt_)
         {
-            switch (event.type)
+            publishStats();
+            nextStatsAt_ = std::chrono::steady_clock::now() + STATS_INTERVAL;
+        }
+
+        // Sleeps until a datagram arrives, a shard flushes or stop() is
+        // called; the timeout only keeps ENet's resend and ping timers going.
+        wakeup_.wait(host_, SERVICE_IDLE_MS);
+    }
+}
+
+void NetworkServer::publishStats()
+{
+    wireTotals_.wirePacketsIn += host_->totalReceivedPackets;
+    wireTotals_.wireBytesIn += host_->totalReceivedData;
+    wireTotals_.wirePacketsOut += host_->totalSentPackets;
+    wireTotals_.wireBytesOut += host_->totalSentData;
+    host_->totalReceivedPackets = 0;
+    host_->totalReceivedData = 0;
+    host_->totalSentPackets = 0;
+    host_->totalSentData = 0;
+
+    publishing_.wirePacketsIn = wireTotals_.wirePacketsIn;
+    publishing_.wireBytesIn = wireTotals_.wireBytesIn;
+    publishing_.wirePacketsOut = wireTotals_.wirePacketsOut;
+    publishing_.wireBytesOut = wireTotals_.wireBytesOut;
+
+    publishing_.peers.clear();
+    for (const auto& [id, entry] : peers_)
+    {
+        const ENetPeer& peer = *entry.peer;
+        publishing_.peers.push_back({ id, entry.shard, entry.packetsIn, entry.bytesIn, entry.packetsOut, entry.bytesOut,
+                                      peer.roundTripTime, peer.roundTripTimeVariance,
+                                      static_cast<float>(peer.packetLoss) / static_cast<float>(ENET_PEER_PACKET_LOSS_SCALE) });
+    }
+    std::sort(publishing_.peers.begin(), publishing_.peers.end(),
+              [](const PeerStats& a, const PeerStats& b) { return a.id < b.id; });
+
+    std::lock_guard lock(statsMutex_);
+    std::swap(stats_, publishing_);
+}
+
+NetworkServer::Stats NetworkServer::stats() const
+{
+    std::lock_guard lock(statsMutex_);
+    return stats_;
+}
+
+void NetworkServer::handleEvent(const ENetEvent& event)
+{
+    switch (event.type)
+    {
+        case ENET_EVENT_TYPE_CONNECT:
+        {
+            Shard* shard = pickShard();
+            if (!shard)
+            {
+                LOG_WARN("[NetworkServer] Rejected a client: every room is full");
+                enet_peer_disconnect_now(event.peer, 0);
+                break;
+            }
+
+            const uint32_t id = nextPeerId_++;
+            event.peer->data = reinterpret_cast<void*>(static_cast<uintptr_t>(id));
+            peers_[id] = { event.peer, shard->index_ };
+            shard->population_.fetch_add(1, std::memory_order_relaxed);
+
+            char ip[64];
+            if (enet_address_get_host_ip(&event.peer->address, ip, sizeof(ip)) != 0)
+            {
+                std::strcpy(ip, "?");
+            }
+            LOG_INFO("[NetworkServer] Client {} connected from {}:{} to room {}", id, ip, event.peer->address.port,
+                     shard->index_);
+            pushEvent(*shard, { EventType::Connect, id, nullptr });
+            break;
+        }
+        case ENET_EVENT_TYPE_RECEIVE:
+        {
+            const auto id = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(event.peer->data));
+            const auto it = peers_.find(id);
+            if (it == peers_.end())
+            {
+                enet_packet_destroy(event.packet);
+                break;
+            }
+            LOG_DEBUG("[NetworkServer] Received {} bytes from client {}", event.packet->dataLength, id);
+            ++it->second.packetsIn;
+            it->second.bytesIn += event.packet->dataLength;
+            pushEvent(*shards_[it->second.shard], { EventType::Receive, id, event.packet });
+            break;
+        }
+        case ENET_EVENT_TYPE_DISCONNECT:
+        {
+            const auto id = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(event.peer->data));
+            const auto it = peers_.find(id);
+            event.peer->data = nullptr;
+            if (it == peers_.end())
             {
-                case ENET_EVENT_TYPE_CONNECT:
-                    std::cout << "Client connected from " << static_cast<int>(event.peer->address.host) << ":"
-                                                          << event.peer->address.port << "\n";
-
-                    break;
-                case ENET_EVENT_TYPE_RECEIVE:
-                    std::cout << "Received packet of length " << event.packet->dataLength << "\n";
-
-                    enet_host_broadcast(host_, event.channelID, event.packet);
-                    enet_packet_destroy(event.packet);
-                    break;
-                case ENET_EVENT_TYPE_DISCONNECT:
-                    std::cout << "Client disconnected\n";
-                    event.peer->data = nullptr;
-                    break;
-                default:
-                    break;
+                break;
             }
+
+            Shard& shard = *shards_[it->second.shard];
+            peers_.erase(it);
+            shard.population_.fetch_sub(1, std::memory_order_relaxed);
+
+            LOG_INFO("[NetworkServer] Client {} disconnected", id);
+            pushEvent(shard, { EventType::Disconnect, id, nullptr });
+            break;
         }
+        default:
+            break;
     }
 }
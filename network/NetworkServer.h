@@ -2,26 +2,204 @@
 
 #include <thread>
 #include <atomic>
+#include <chrono>
 #include <vector>
+#include <functional>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+
+#include "Protocol.h"
+#include "SpscQueue.h"
+#include "OutgoingQueue.h"
+#include "WakeupSignal.h"
 
 struct _ENetHost;
+struct _ENetPeer;
+struct _ENetPacket;
+struct _ENetEvent;
 
+// Transport for the authoritative server. The service thread only moves
+// packets: connects, disconnects and received packets go into an SPSC inbox
+// that the simulation thread drains with poll(); sends are batched per peer
+// and handed to ENet by the service thread. Peers are named by ids that are
+// never reused, so a stale id can't reach a new connection.
+//
+// The peers can be split between shards, one per match room. Each shard has
+// its own inbox and outgoing batches, so every room can be simulated on a
+// different thread; the service thread assigns connecting peers to the
+// first shard with space and routes each packet to its peer's shard.
 class NetworkServer
 {
 public:
-    explicit NetworkServer(uint16_t port = 1234);
+    enum class EventType : uint8_t
+    {
+        Connect,
+        Disconnect,
+        Receive
+    };
+
+    // For Receive, `data`/`size` is one frame, valid only during the call.
+    using EventHandler = std::function<void(EventType type, uint32_t peer, const uint8_t* data, std::size_t size)>;
+
+    // Counted by the service thread: payload bytes as handed to and from
+    // ENet, one packet per datagram.
+    struct PeerStats
+    {
+        uint32_t id = 0;
+        std::size_t room = 0;
+        uint64_t packetsIn = 0;
+        uint64_t bytesIn = 0;
+        uint64_t packetsOut = 0;
+        uint64_t bytesOut = 0;
+        // ENet's smoothed estimates.
+        uint32_t rttMs = 0;
+        uint32_t rttVarianceMs = 0;
+        float packetLoss = 0.0f;
+    };
+
+    struct Stats
+    {
+        // On the wire, ENet headers, acknowledgements and resends included.
+        uint64_t wirePacketsIn = 0;
+        uint64_t wireBytesIn = 0;
+        uint64_t wirePacketsOut = 0;
+        uint64_t wireBytesOut = 0;
+        std::vector<PeerStats> peers;
+    };
+
+private:
+    struct Event
+    {
+        EventType type;
+        uint32_t peer;
+        struct _ENetPacket* packet;
+    };
+
+    static constexpr std::size_t INBOX_CAPACITY = 4096;
+
+public:
+    // One room's view of the server. Only one thread at a time may poll or
+    // send through a shard; different shards need no coordination.
+    class Shard
+    {
+    public:
+        std::size_t poll(const EventHandler& handler);
+
+        void send(uint32_t peer, const std::vector<uint8_t>& data, Channel channel);
+        // To every peer of this shard.
+        void broadcast(const std::vector<uint8_t>& data, Channel channel = Channel::Events);
+        // Seals this tick's batches; call once per simulation tick.
+        void flush();
+
+        // Moves `peer` to shard `to` if it has space: this shard then sees
+        // the peer disconnect and `to` sees it connect, after which its
+        // packets go there.
+        void transfer(uint32_t peer, std::size_t to);
+
+        [[nodiscard]] std::size_t index() const { return index_; }
+        [[nodiscard]] std::size_t population() const { return population_.load(std::memory_order_relaxed); }
+        [[nodiscard]] uint64_t droppedPackets() const { return dropped_.load(std::memory_order_relaxed); }
+        // Received events waiting for poll(), and datagrams sealed by flush()
+        // waiting for the service thread.
+        [[nodiscard]] std::size_t inboxDepth() const { return inbox_.SizeApprox(); }
+        [[nodiscard]] std::size_t outgoingDepth() const { return outgoing_.pending(); }
+
+    private:
+        friend class NetworkServer;
+
+        Shard(NetworkServer& server, std::size_t index) : server_(server), index_(index) {}
+
+        NetworkServer& server_;
+        std::size_t index_;
+
+        SpscQueue<Event, INBOX_CAPACITY> inbox_;
+        std::atomic<uint64_t> dropped_{0};
+        // Written by the service thread only.
+        std::atomic<std::size_t> population_{0};
+
+        OutgoingQueue outgoing_;
+    };
+
+    // `shardCapacity` 0 means unlimited; a peer arriving when every shard
+    // is full is turned away.
+    explicit NetworkServer(uint16_t port = 1234, std::size_t maxPeers = 32,
+                           std::size_t shardCount = 1, std::size_t shardCapacity = 0);
     ~NetworkServer();
 
     bool start();
     void stop();
-    void broadcast(const std::vector<uint8_t>& data) const;
+
+    [[nodiscard]] Shard& shard(std::size_t index) { return *shards_[index]; }
+    [[nodiscard]] std::size_t shardCount() const { return shards_.size(); }
+
+    // Shortcuts for the single-shard server.
+    std::size_t poll(const EventHandler& handler) { return shard(0).poll(handler); }
+    void send(uint32_t peer, const std::vector<uint8_t>& data, Channel channel) { shard(0).send(peer, data, channel); }
+    void broadcast(const std::vector<uint8_t>& data, Channel channel = Channel::Events) { shard(0).broadcast(data, channel); }
+    void flush() { shard(0).flush(); }
+
+    [[nodiscard]] uint64_t droppedPackets() const;
+
+    // As of the service thread's last publish, at most STATS_INTERVAL ago.
+    [[nodiscard]] Stats stats() const;
+
+    static constexpr uint32_t BROADCAST_PEER = 0;
 
 private:
-    void serviceLoop() const;
+    struct PeerEntry
+    {
+        struct _ENetPeer* peer;
+        std::size_t shard;
+        uint64_t packetsIn = 0;
+        uint64_t bytesIn = 0;
+        uint64_t packetsOut = 0;
+        uint64_t bytesOut = 0;
+    };
+
+    struct Transfer
+    {
+        uint32_t peer;
+        std::size_t to;
+    };
+
+    void serviceLoop();
+    void handleEvent(const struct _ENetEvent& event);
+    void sendOutgoing(Shard& shard);
+    void applyTransfers();
+    void pushEvent(Shard& shard, const Event& event);
+    void publishStats();
+    [[nodiscard]] Shard* pickShard();
 
     _ENetHost* host_ = nullptr;
     uint16_t port_;
+    std::size_t maxPeers_;
+    std::size_t shardCapacity_;
     std::thread thread_;
 
     std::atomic<bool> running_{false};
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    // Service thread only.
+    uint32_t nextPeerId_ = 1;
+    std::unordered_map<uint32_t, PeerEntry> peers_;
+    std::vector<OutgoingQueue::Datagram> sending_;
+
+    // Shard threads -> service thread.
+    std::mutex transferMutex_;
+    std::vector<Transfer> transfers_;
+    std::vector<Transfer> applying_;
+
+    WakeupSignal wakeup_;
+    static constexpr uint32_t SERVICE_IDLE_MS = 10;
+
+    // Service thread -> stats(). Rebuilt off to the side, then swapped in.
+    mutable std::mutex statsMutex_;
+    Stats stats_;
+    Stats publishing_;
+    // Service thread only: ENet's 32-bit host totals, carried into 64 bits.
+    Stats wireTotals_;
+    std::chrono::steady_clock::time_point nextStatsAt_;
+    static constexpr std::chrono::milliseconds STATS_INTERVAL{500};
 };
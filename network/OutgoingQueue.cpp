@@ -0,0 +1,59 @@
+#include "OutgoingQueue.h"
+
+#include <algorithm>
+#include <utility>
+
+// Worst-case varint length prefix for one frame.
+static constexpr std::size_t FRAME_HEADER_MAX = 5;
+
+void OutgoingQueue::push(const uint32_t peer, const Channel channel, const uint8_t* data, const std::size_t size)
+{
+    std::lock_guard lock(mutex_);
+
+    std::vector<uint8_t>& batch = batches_[peer][static_cast<std::size_t>(channel)];
+    if (!batch.empty() && batch.size() + size + FRAME_HEADER_MAX > MAX_DATAGRAM_SIZE)
+    {
+        sealed_.push_back({ peer, channel, std::move(batch) });
+        batch.clear();
+    }
+    appendFrame(batch, data, size);
+}
+
+void OutgoingQueue::seal()
+{
+    std::lock_guard lock(mutex_);
+
+    for (auto& [peer, channels] : batches_)
+    {
+        for (std::size_t c = 0; c < CHANNEL_COUNT; ++c)
+        {
+            if (!channels[c].empty())
+            {
+                sealed_.push_back({ peer, static_cast<Channel>(c), std::move(channels[c]) });
+                channels[c].clear();
+            }
+        }
+    }
+}
+
+void OutgoingQueue::drain(std::vector<Datagram>& out)
+{
+    out.clear();
+
+    std::lock_guard lock(mutex_);
+    out.swap(sealed_);
+}
+
+void OutgoingQueue::forget(const uint32_t peer)
+{
+    std::lock_guard lock(mutex_);
+
+    batches_.erase(peer);
+    std::erase_if(sealed_, [peer](const Datagram& d) { return d.peer == peer; });
+}
+
+std::size_t OutgoingQueue::pending() const
+{
+    std::lock_guard lock(mutex_);
+    return sealed_.size();
+}
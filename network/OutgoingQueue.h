@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Protocol.h"
+
+// Per-peer, per-channel message batching shared by client and server. The
+// game thread push()es length-prefixed frames and seal()s once per tick; the
+// service thread drain()s the finished datagrams and hands them to ENet.
+class OutgoingQueue
+{
+public:
+    struct Datagram
+    {
+        uint32_t peer;
+        Channel channel;
+        std::vector<uint8_t> bytes;
+    };
+
+    void push(uint32_t peer, Channel channel, const uint8_t* data, std::size_t size);
+    void seal();
+    void drain(std::vector<Datagram>& out);
+
+    // Drops anything still batched or queued for `peer`.
+    void forget(uint32_t peer);
+
+    // Sealed datagrams the service thread has yet to drain.
+    [[nodiscard]] std::size_t pending() const;
+
+    // Below the common 1400-byte path MTU once ENet and UDP headers are added,
+    // so unreliable state never fragments.
+    static constexpr std::size_t MAX_DATAGRAM_SIZE = 1200;
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<uint32_t, std::array<std::vector<uint8_t>, CHANNEL_COUNT>> batches_;
+    std::vector<Datagram> sealed_;
+};
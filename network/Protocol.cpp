@@ -0,0 +1,728 @@
+#include "Protocol.h"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+// 1/16 px over the largest arena the level generator produces, with room
+// for actors knocked outside the walls.
+static constexpr float POS_MIN  = -1024.0f;
+static constexpr float POS_MAX  = 7168.0f;
+static constexpr int   POS_BITS = 17;
+
+// 1/4 px/s; covers bullet speed and terminal falls.
+static constexpr float VEL_MIN  = -2048.0f;
+static constexpr float VEL_MAX  = 2048.0f;
+static constexpr int   VEL_BITS = 14;
+
+static constexpr int TYPE_BITS      = 4;
+static constexpr int HEALTH_BITS    = 8;
+static constexpr int BOT_STATE_BITS = 2;
+static constexpr int MOVE_BITS      = 8;
+static constexpr long MOVE_SCALE    = 127;
+static constexpr int SPREAD_BITS    = 8;
+static constexpr float SPREAD_MAX   = 256.0f;
+
+// Delta-coded snapshot fields: a change that fits in this many zigzag bits
+// is sent as a difference from the baseline, anything larger in full.
+// 10 bits of position is 32 px, several ticks of a sprint.
+static constexpr int POS_DELTA_BITS = 10;
+static constexpr int VEL_DELTA_BITS = 9;
+
+void Packet::clear()
+{
+    players.clear();
+    bots.clear();
+    shots.clear();
+    hits.clear();
+    inputs.clear();
+    welcomes.clear();
+    snapshots.clear();
+    joinRooms.clear();
+    acks.clear();
+}
+
+void SnapshotHistory::store(const uint32_t tick, const std::vector<PlayerStateMsg>& players,
+                            const std::vector<BotStateMsg>& bots)
+{
+    Entry& entry = entries_[tick % WINDOW_TICKS];
+    entry.tick = tick;
+    entry.players.assign(players.begin(), players.end());
+    entry.bots.assign(bots.begin(), bots.end());
+}
+
+const SnapshotHistory::Entry* SnapshotHistory::find(const uint32_t tick) const
+{
+    const Entry& entry = entries_[tick % WINDOW_TICKS];
+    return tick != 0 && entry.tick == tick ? &entry : nullptr;
+}
+
+void SnapshotHistory::clear()
+{
+    for (auto& entry : entries_)
+    {
+        entry.tick = 0;
+        entry.players.clear();
+        entry.bots.clear();
+    }
+}
+
+static uint32_t quantize(const float value, const float min, const float max, const int bits)
+{
+    const uint32_t steps = (1u << bits) - 1u;
+    const float t = (std::clamp(value, min, max) - min) / (max - min);
+    return static_cast<uint32_t>(std::lround(t * static_cast<float>(steps)));
+}
+
+static float dequantize(const uint32_t value, const float min, const float max, const int bits)
+{
+    const uint32_t steps = (1u << bits) - 1u;
+    return min + static_cast<float>(value) / static_cast<float>(steps) * (max - min);
+}
+
+void BitWriter::writeBits(uint32_t value, int bits)
+{
+    while (bits > 0)
+    {
+        const int offset = static_cast<int>(bitPos_ & 7);
+        if (offset == 0)
+        {
+            bytes_.push_back(0);
+        }
+
+        const int take = std::min(bits, 8 - offset);
+        bytes_.back() |= static_cast<uint8_t>((value & ((1u << take) - 1u)) << offset);
+
+        value >>= take;
+        bits -= take;
+        bitPos_ += take;
+    }
+}
+
+void BitWriter::writeVarUint(uint32_t value)
+{
+    while (value >= 0x80u)
+    {
+        writeBits((value & 0x7Fu) | 0x80u, 8);
+        value >>= 7;
+    }
+    writeBits(value, 8);
+}
+
+void BitWriter::writeQuantized(const float value, const float min, const float max, const int bits)
+{
+    writeBits(quantize(value, min, max, bits), bits);
+}
+
+void BitWriter::clear()
+{
+    bytes_.clear();
+    bitPos_ = 0;
+}
+
+BitReader::BitReader(const uint8_t* data, const std::size_t size)
+    : data_(data), bitSize_(size * 8) {}
+
+uint32_t BitReader::readBits(const int bits)
+{
+    if (bitPos_ + static_cast<std::size_t>(bits) > bitSize_)
+    {
+        overflow_ = true;
+        bitPos_ = bitSize_;
+        return 0;
+    }
+
+    uint32_t value = 0;
+    int done = 0;
+    while (done < bits)
+    {
+        const int offset = static_cast<int>(bitPos_ & 7);
+        const int take = std::min(bits - done, 8 - offset);
+        const uint32_t chunk = (static_cast<uint32_t>(data_[bitPos_ >> 3]) >> offset) & ((1u << take) - 1u);
+
+        value |= chunk << done;
+        done += take;
+        bitPos_ += take;
+    }
+    return value;
+}
+
+uint32_t BitReader::readVarUint()
+{
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        const uint32_t group = readBits(8);
+        value |= (group & 0x7Fu) << shift;
+        if ((group & 0x80u) == 0)
+        {
+            return value;
+        }
+    }
+
+    overflow_ = true;
+    return 0;
+}
+
+float BitReader::readQuantized(const float min, const float max, const int bits)
+{
+    return dequantize(readBits(bits), min, max, bits);
+}
+
+static void writePosition(BitWriter& w, const Vector2 v)
+{
+    w.writeQuantized(v.x, POS_MIN, POS_MAX, POS_BITS);
+    w.writeQuantized(v.y, POS_MIN, POS_MAX, POS_BITS);
+}
+
+static void writeVelocity(BitWriter& w, const Vector2 v)
+{
+    w.writeQuantized(v.x, VEL_MIN, VEL_MAX, VEL_BITS);
+    w.writeQuantized(v.y, VEL_MIN, VEL_MAX, VEL_BITS);
+}
+
+static Vector2 readPosition(BitReader& r)
+{
+    const float x = r.readQuantized(POS_MIN, POS_MAX, POS_BITS);
+    const float y = r.readQuantized(POS_MIN, POS_MAX, POS_BITS);
+    return { x, y };
+}
+
+static Vector2 readVelocity(BitReader& r)
+{
+    const float x = r.readQuantized(VEL_MIN, VEL_MAX, VEL_BITS);
+    const float y = r.readQuantized(VEL_MIN, VEL_MAX, VEL_BITS);
+    return { x, y };
+}
+
+// Snapshot entities are compared and delta-coded in their quantized form, so
+// the server's raw baseline and the client's decoded one produce the same
+// integers and never drift apart.
+struct FieldSpec
+{
+    int bits;
+    int deltaBits; // 0: always sent in full
+};
+
+// position x/y, velocity x/y, health, bot state
+static constexpr FieldSpec ENTITY_FIELDS[] = {
+    { POS_BITS, POS_DELTA_BITS },
+    { POS_BITS, POS_DELTA_BITS },
+    { VEL_BITS, VEL_DELTA_BITS },
+    { VEL_BITS, VEL_DELTA_BITS },
+    { HEALTH_BITS, 0 },
+    { BOT_STATE_BITS, 0 },
+};
+
+static constexpr int PLAYER_FIELD_COUNT = 5;
+static constexpr int BOT_FIELD_COUNT = 6;
+
+struct EntityFields
+{
+    std::array<uint32_t, BOT_FIELD_COUNT> values{};
+};
+
+static int fieldCount(const PlayerStateMsg&) { return PLAYER_FIELD_COUNT; }
+static int fieldCount(const BotStateMsg&) { return BOT_FIELD_COUNT; }
+
+template <typename Msg>
+static EntityFields toFields(const Msg& m)
+{
+    EntityFields f;
+    f.values[0] = quantize(m.position.x, POS_MIN, POS_MAX, POS_BITS);
+    f.values[1] = quantize(m.position.y, POS_MIN, POS_MAX, POS_BITS);
+    f.values[2] = quantize(m.velocity.x, VEL_MIN, VEL_MAX, VEL_BITS);
+    f.values[3] = quantize(m.velocity.y, VEL_MIN, VEL_MAX, VEL_BITS);
+    f.values[4] = m.health;
+    if constexpr (std::is_same_v<Msg, BotStateMsg>)
+    {
+        f.values[5] = m.state;
+    }
+    return f;
+}
+
+template <typename Msg>
+static void fromFields(const EntityFields& f, Msg& m)
+{
+    m.position = { dequantize(f.values[0], POS_MIN, POS_MAX, POS_BITS), dequantize(f.values[1], POS_MIN, POS_MAX, POS_BITS) };
+    m.velocity = { dequantize(f.values[2], VEL_MIN, VEL_MAX, VEL_BITS), dequantize(f.values[3], VEL_MIN, VEL_MAX, VEL_BITS) };
+    m.health   = static_cast<uint8_t>(f.values[4]);
+    if constexpr (std::is_same_v<Msg, BotStateMsg>)
+    {
+        m.state = static_cast<uint8_t>(f.values[5]);
+    }
+}
+
+static uint32_t zigzagDelta(const uint32_t value, const uint32_t base)
+{
+    const int32_t diff = static_cast<int32_t>(value - base);
+    return (static_cast<uint32_t>(diff) << 1) ^ static_cast<uint32_t>(diff >> 31);
+}
+
+static void writeField(BitWriter& w, const FieldSpec& spec, const uint32_t value, const uint32_t* base)
+{
+    if (base && spec.deltaBits > 0)
+    {
+        const uint32_t zigzag = zigzagDelta(value, *base);
+        const bool small = zigzag < (1u << spec.deltaBits);
+        w.writeBool(small);
+        if (small)
+        {
+            w.writeBits(zigzag, spec.deltaBits);
+            return;
+        }
+    }
+    w.writeBits(value, spec.bits);
+}
+
+static uint32_t readField(BitReader& r, const FieldSpec& spec, const uint32_t* base)
+{
+    if (base && spec.deltaBits > 0 && r.readBool())
+    {
+        const uint32_t zigzag = r.readBits(spec.deltaBits);
+        const int32_t diff = static_cast<int32_t>(zigzag >> 1) ^ -static_cast<int32_t>(zigzag & 1u);
+        return (*base + static_cast<uint32_t>(diff)) & ((1u << spec.bits) - 1u);
+    }
+    return r.readBits(spec.bits);
+}
+
+// Records, each prefixed by a continuation bit, walk both id-sorted lists:
+//
+//   idGap:varint  removed:1  [ mask:n  changed fields ]   entity in baseline
+//   idGap:varint  0          all fields                   new entity
+//
+// Entities unchanged since the baseline are not mentioned at all.
+template <typename Msg>
+static void writeEntities(BitWriter& w, const std::vector<Msg>& current, const std::vector<Msg>* baseline)
+{
+    static const std::vector<Msg> none;
+    const std::vector<Msg>& base = baseline ? *baseline : none;
+
+    uint32_t lastId = 0;
+    const auto beginRecord = [&](const uint32_t id, const bool removed)
+    {
+        w.writeBool(true);
+        w.writeVarUint(id - lastId);
+        w.writeBool(removed);
+        lastId = id;
+    };
+
+    std::size_t j = 0;
+    for (const Msg& m : current)
+    {
+        for (; j < base.size() && base[j].id < m.id; ++j)
+        {
+            beginRecord(base[j].id, true);
+        }
+
+        const EntityFields fields = toFields(m);
+        const int count = fieldCount(m);
+
+        if (j < base.size() && base[j].id == m.id)
+        {
+            const EntityFields old = toFields(base[j++]);
+
+            uint32_t mask = 0;
+            for (int f = 0; f < count; ++f)
+            {
+                if (fields.values[f] != old.values[f]) mask |= 1u << f;
+            }
+            if (mask == 0)
+            {
+                continue;
+            }
+
+            beginRecord(m.id, false);
+            w.writeBits(mask, count);
+            for (int f = 0; f < count; ++f)
+            {
+                if (mask & (1u << f)) writeField(w, ENTITY_FIELDS[f], fields.values[f], &old.values[f]);
+            }
+        }
+        else
+        {
+            beginRecord(m.id, false);
+            for (int f = 0; f < count; ++f)
+            {
+                writeField(w, ENTITY_FIELDS[f], fields.values[f], nullptr);
+            }
+        }
+    }
+    for (; j < base.size(); ++j)
+    {
+        beginRecord(base[j].id, true);
+    }
+
+    w.writeBool(false);
+}
+
+static std::size_t varUintBits(uint32_t value)
+{
+    std::size_t bits = 8;
+    for (; value >= 0x80u; value >>= 7)
+    {
+        bits += 8;
+    }
+    return bits;
+}
+
+static std::size_t fieldBits(const FieldSpec& spec, const uint32_t value, const uint32_t* base)
+{
+    if (base && spec.deltaBits > 0)
+    {
+        const uint32_t zigzag = zigzagDelta(value, *base);
+        return 1 + static_cast<std::size_t>(zigzag < (1u << spec.deltaBits) ? spec.deltaBits : spec.bits);
+    }
+    return static_cast<std::size_t>(spec.bits);
+}
+
+// Mirrors writeEntities and beginRecord.
+template <typename Msg>
+static std::size_t entityBits(const Msg& m, const Msg* baseline)
+{
+    const EntityFields fields = toFields(m);
+    const int count = fieldCount(m);
+    std::size_t bits = 1 + varUintBits(m.id) + 1;
+
+    if (baseline)
+    {
+        const EntityFields old = toFields(*baseline);
+        bool changed = false;
+        for (int f = 0; f < count; ++f)
+        {
+            if (fields.values[f] != old.values[f])
+            {
+                bits += fieldBits(ENTITY_FIELDS[f], fields.values[f], &old.values[f]);
+                changed = true;
+            }
+        }
+        return changed ? bits + static_cast<std::size_t>(count) : 0;
+    }
+
+    for (int f = 0; f < count; ++f)
+    {
+        bits += fieldBits(ENTITY_FIELDS[f], fields.values[f], nullptr);
+    }
+    return bits;
+}
+
+std::size_t snapshotHeaderBits(const SnapshotMsg& header)
+{
+    // Version and message count of a packet holding just the snapshot, its
+    // type, the fields and both entity lists' end markers.
+    return 8 + varUintBits(1) + TYPE_BITS + varUintBits(header.tick) + varUintBits(header.baseTick != 0 ? header.tick - header.baseTick : 0) +
+           varUintBits(header.ackedInput) + VEL_BITS + 1 + 2;
+}
+
+std::size_t snapshotEntityBits(const PlayerStateMsg& state, const PlayerStateMsg* baseline)
+{
+    return entityBits(state, baseline);
+}
+
+std::size_t snapshotEntityBits(const BotStateMsg& state, const BotStateMsg* baseline)
+{
+    return entityBits(state, baseline);
+}
+
+std::size_t snapshotRemovalBits(const uint32_t id)
+{
+    return 1 + varUintBits(id) + 1;
+}
+
+template <typename Msg>
+static bool readEntities(BitReader& r, const std::vector<Msg>* baseline, std::vector<Msg>& out)
+{
+    static const std::vector<Msg> none;
+    const std::vector<Msg>& base = baseline ? *baseline : none;
+
+    uint32_t lastId = 0;
+    std::size_t j = 0;
+    while (r.ok() && r.readBool())
+    {
+        const uint32_t gap = r.readVarUint();
+        const uint32_t id = lastId + gap;
+        const bool removed = r.readBool();
+        if (gap == 0 && lastId != 0)
+        {
+            return false;
+        }
+        lastId = id;
+
+        for (; j < base.size() && base[j].id < id; ++j)
+        {
+            out.push_back(base[j]);
+        }
+
+        const bool known = j < base.size() && base[j].id == id;
+        if (removed)
+        {
+            if (!known) return false;
+            ++j;
+            continue;
+        }
+
+        Msg& m = out.emplace_back();
+        m.id = id;
+        const int count = fieldCount(m);
+
+        if (known)
+        {
+            const EntityFields old = toFields(base[j++]);
+            EntityFields fields = old;
+
+            const uint32_t mask = r.readBits(count);
+            for (int f = 0; f < count; ++f)
+            {
+                if (mask & (1u << f)) fields.values[f] = readField(r, ENTITY_FIELDS[f], &old.values[f]);
+            }
+            fromFields(fields, m);
+        }
+        else
+        {
+            EntityFields fields;
+            for (int f = 0; f < count; ++f)
+            {
+                fields.values[f] = readField(r, ENTITY_FIELDS[f], nullptr);
+            }
+            fromFields(fields, m);
+        }
+    }
+
+    out.insert(out.end(), base.begin() + static_cast<std::ptrdiff_t>(j), base.end());
+    return r.ok();
+}
+
+void encodePacket(const Packet& packet, BitWriter& writer, const SnapshotHistory* baselines)
+{
+    // With a snapshot the players and bots travel inside it.
+    const bool snapshot = !packet.snapshots.empty();
+    const std::size_t entities = snapshot ? 0 : packet.players.size() + packet.bots.size();
+
+    writer.writeBits(PROTOCOL_VERSION, 8);
+    writer.writeVarUint(static_cast<uint32_t>(entities + packet.shots.size() + packet.hits.size() +
+                                              packet.inputs.size() + packet.welcomes.size() +
+                                              packet.acks.size() + packet.joinRooms.size() + (snapshot ? 1 : 0)));
+
+    for (const auto& m : packet.welcomes)
+    {
+        writer.writeBits(static_cast<uint32_t>(MessageType::Welcome), TYPE_BITS);
+        writer.writeVarUint(m.playerId);
+        writer.writeVarUint(m.tickRate);
+        writer.writeVarUint(m.room);
+    }
+
+    if (snapshot)
+    {
+        const SnapshotMsg& m = packet.snapshots.front();
+        const SnapshotHistory::Entry* base =
+            baselines && m.baseTick != 0 && m.baseTick < m.tick ? baselines->find(m.baseTick) : nullptr;
+
+        writer.writeBits(static_cast<uint32_t>(MessageType::Snapshot), TYPE_BITS);
+        writer.writeVarUint(m.tick);
+        writer.writeVarUint(base ? m.tick - m.baseTick : 0);
+        writer.writeVarUint(m.ackedInput);
+        writer.writeQuantized(m.playerSpeed, VEL_MIN, VEL_MAX, VEL_BITS);
+        writer.writeBool(m.playerCanJump);
+        writeEntities(writer, packet.players, base ? &base->players : nullptr);
+        writeEntities(writer, packet.bots, base ? &base->bots : nullptr);
+    }
+
+    for (const auto& m : packet.acks)
+    {
+        writer.writeBits(static_cast<uint32_t>(MessageType::Ack), TYPE_BITS);
+        writer.writeVarUint(m.tick);
+    }
+
+    for (const auto& m : packet.joinRooms)
+    {
+        writer.writeBits(static_cast<uint32_t>(MessageType::JoinRoom), TYPE_BITS);
+        writer.writeVarUint(m.room);
+    }
+
+    for (const auto& m : packet.inputs)
+    {
+        writer.writeBits(static_cast<uint32_t>(MessageType::Input), TYPE_BITS);
+        writer.writeVarUint(m.sequence);
+        // Symmetric around zero so "not moving" survives the round trip exactly.
+        writer.writeBits(static_cast<uint32_t>(std::lround(std::clamp(m.moveX, -1.0f, 1.0f) * MOVE_SCALE) + MOVE_SCALE), MOVE_BITS);
+        writer.writeBool(m.jump);
+        writer.writeBool(m.fire);
+        writePosition(writer, m.aim);
+        writer.writeQuantized(m.spread, 0.0f, SPREAD_MAX, SPREAD_BITS);
+        writer.writeVarUint(m.viewTick);
+    }
+
+    if (!snapshot)
+    {
+        for (const auto& m : packet.players)
+        {
+            writer.writeBits(static_cast<uint32_t>(MessageType::PlayerState), TYPE_BITS);
+            writer.writeVarUint(m.id);
+            writePosition(writer, m.position);
+            writeVelocity(writer, m.velocity);
+            writer.writeBits(m.health, HEALTH_BITS);
+        }
+
+        for (const auto& m : packet.bots)
+        {
+            writer.writeBits(static_cast<uint32_t>(MessageType::BotState), TYPE_BITS);
+            writer.writeVarUint(m.id);
+            writePosition(writer, m.position);
+            writeVelocity(writer, m.velocity);
+            writer.writeBits(m.health, HEALTH_BITS);
+            writer.writeBits(m.state, BOT_STATE_BITS);
+        }
+    }
+
+    for (const auto& m : packet.shots)
+    {
+        writer.writeBits(static_cast<uint32_t>(MessageType::Shot), TYPE_BITS);
+        writer.writeVarUint(m.ownerId);
+        writePosition(writer, m.origin);
+        writeVelocity(writer, m.velocity);
+    }
+
+    for (const auto& m : packet.hits)
+    {
+        writer.writeBits(static_cast<uint32_t>(MessageType::Hit), TYPE_BITS);
+        writer.writeVarUint(m.ownerId);
+        writer.writeVarUint(m.targetId);
+        writer.writeVarUint(m.damage);
+        writePosition(writer, m.point);
+    }
+}
+
+std::vector<uint8_t> encodePacket(const Packet& packet)
+{
+    BitWriter writer;
+    encodePacket(packet, writer);
+    return writer.data();
+}
+
+bool decodePacket(const uint8_t* data, const std::size_t size, Packet& out, const SnapshotHistory* baselines)
+{
+    BitReader reader(data, size);
+    if (reader.readBits(8) != PROTOCOL_VERSION)
+    {
+        return false;
+    }
+
+    const uint32_t count = reader.readVarUint();
+    for (uint32_t i = 0; i < count && reader.ok(); ++i)
+    {
+        switch (static_cast<MessageType>(reader.readBits(TYPE_BITS)))
+        {
+            case MessageType::PlayerState:
+            {
+                PlayerStateMsg& m = out.players.emplace_back();
+                m.id       = reader.readVarUint();
+                m.position = readPosition(reader);
+                m.velocity = readVelocity(reader);
+                m.health   = static_cast<uint8_t>(reader.readBits(HEALTH_BITS));
+                break;
+            }
+            case MessageType::BotState:
+            {
+                BotStateMsg& m = out.bots.emplace_back();
+                m.id       = reader.readVarUint();
+                m.position = readPosition(reader);
+                m.velocity = readVelocity(reader);
+                m.health   = static_cast<uint8_t>(reader.readBits(HEALTH_BITS));
+                m.state    = static_cast<uint8_t>(reader.readBits(BOT_STATE_BITS));
+                break;
+            }
+            case MessageType::Shot:
+            {
+                ShotMsg& m = out.shots.emplace_back();
+                m.ownerId  = reader.readVarUint();
+                m.origin   = readPosition(reader);
+                m.velocity = readVelocity(reader);
+                break;
+            }
+            case MessageType::Hit:
+            {
+                HitMsg& m = out.hits.emplace_back();
+                m.ownerId  = reader.readVarUint();
+                m.targetId = reader.readVarUint();
+                m.damage   = reader.readVarUint();
+                m.point    = readPosition(reader);
+                break;
+            }
+            case MessageType::Input:
+            {
+                InputMsg& m = out.inputs.emplace_back();
+                m.sequence = reader.readVarUint();
+                m.moveX    = (static_cast<float>(reader.readBits(MOVE_BITS)) - MOVE_SCALE) / MOVE_SCALE;
+                m.jump     = reader.readBool();
+                m.fire     = reader.readBool();
+                m.aim      = readPosition(reader);
+                m.spread   = reader.readQuantized(0.0f, SPREAD_MAX, SPREAD_BITS);
+                m.viewTick = reader.readVarUint();
+                break;
+            }
+            case MessageType::Welcome:
+            {
+                WelcomeMsg& m = out.welcomes.emplace_back();
+                m.playerId = reader.readVarUint();
+                m.tickRate = reader.readVarUint();
+                m.room     = reader.readVarUint();
+                break;
+            }
+            case MessageType::Snapshot:
+            {
+                SnapshotMsg& m = out.snapshots.emplace_back();
+                m.tick = reader.readVarUint();
+                const uint32_t distance = reader.readVarUint();
+                m.ackedInput = reader.readVarUint();
+                m.playerSpeed = reader.readQuantized(VEL_MIN, VEL_MAX, VEL_BITS);
+                m.playerCanJump = reader.readBool();
+
+                const SnapshotHistory::Entry* base = nullptr;
+                if (distance != 0)
+                {
+                    m.baseTick = m.tick - distance;
+                    base = baselines ? baselines->find(m.baseTick) : nullptr;
+                    if (!base)
+                    {
+                        return false;
+                    }
+                }
+
+                if (!readEntities(reader, base ? &base->players : nullptr, out.players) ||
+                    !readEntities(reader, base ? &base->bots : nullptr, out.bots))
+                {
+                    return false;
+                }
+                break;
+            }
+            case MessageType::Ack:
+            {
+                AckMsg& m = out.acks.emplace_back();
+                m.tick = reader.readVarUint();
+                break;
+            }
+            case MessageType::JoinRoom:
+            {
+                JoinRoomMsg& m = out.joinRooms.emplace_back();
+                m.room = reader.readVarUint();
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+
+    return reader.ok();
+}
+
+void appendFrame(std::vector<uint8_t>& datagram, const uint8_t* data, const std::size_t size)
+{
+    std::size_t length = size;
+    while (length >= 0x80u)
+    {
+        datagram.push_back(static_cast<uint8_t>((length & 0x7Fu) | 0x80u));
+        length >>= 7;
+    }
+    datagram.push_back(static_cast<uint8_t>(length));
+    datagram.insert(datagram.end(), data, data + size);
+}
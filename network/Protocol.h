@@ -0,0 +1,283 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "raylib.h"
+
+// Wire format shared by client and server. A packet is
+//
+//   version:8  count:varint  { type:4  payload }*count
+//
+// bit-packed with no alignment between fields. Positions and velocities are
+// quantized to fixed ranges; ids and other unbounded integers are varints
+// (7 bits per group plus a continuation bit).
+
+static constexpr uint8_t PROTOCOL_VERSION = 6;
+
+// ENet channel per traffic class. State is sent unreliable-sequenced, so a
+// lost update is simply superseded by the next one; events are reliable.
+enum class Channel : uint8_t
+{
+    State  = 0,
+    Events = 1
+};
+
+static constexpr std::size_t CHANNEL_COUNT = 2;
+
+enum class MessageType : uint8_t
+{
+    PlayerState = 0,
+    BotState    = 1,
+    Shot        = 2,
+    Hit         = 3,
+    Input       = 4,
+    Welcome     = 5,
+    Snapshot    = 6,
+    Ack         = 7,
+    JoinRoom    = 8
+};
+
+struct PlayerStateMsg
+{
+    uint32_t id = 0;
+    Vector2 position{};
+    Vector2 velocity{};
+    uint8_t health = 0;
+};
+
+struct BotStateMsg
+{
+    uint32_t id = 0;
+    Vector2 position{};
+    Vector2 velocity{};
+    uint8_t health = 0;
+    uint8_t state = 0;
+};
+
+struct ShotMsg
+{
+    uint32_t ownerId = 0;
+    Vector2 origin{};
+    Vector2 velocity{};
+};
+
+struct HitMsg
+{
+    uint32_t ownerId = 0;
+    uint32_t targetId = 0;
+    uint32_t damage = 0;
+    Vector2 point{};
+};
+
+// Client -> server, one per simulation tick. Clients repeat their last few
+// commands in every packet so a lost datagram costs nothing.
+struct InputMsg
+{
+    uint32_t sequence = 0;
+    float moveX = 0.0f;
+    bool jump = false;
+    bool fire = false;
+    Vector2 aim{};
+    float spread = 0.0f;
+    // Server tick the client was drawing remote actors at, for rewinding
+    // the hit test of any shot this input fires.
+    uint32_t viewTick = 0;
+};
+
+// Server -> client, reliable, once after connecting and again after every
+// move to another room.
+struct WelcomeMsg
+{
+    uint32_t playerId = 0;
+    uint32_t tickRate = 0;
+    uint32_t room = 0;
+};
+
+// Server -> client header for the player/bot states in the same packet,
+// which are then coded inside the snapshot instead of as separate messages:
+// only entities that changed since the snapshot at `baseTick` are sent, each
+// with a mask of the fields that changed (baseTick 0 = full snapshot). Both
+// lists must be sorted by id. `ackedInput` is the last input sequence the
+// server applied for this client; with the receiving client's own vertical
+// speed and jump state (which its position alone can't restore) it is what
+// the client reconciles its prediction against.
+struct SnapshotMsg
+{
+    uint32_t tick = 0;
+    uint32_t baseTick = 0;
+    uint32_t ackedInput = 0;
+    float playerSpeed = 0.0f;
+    bool playerCanJump = false;
+};
+
+// Client -> server: the newest snapshot the client has decoded, which the
+// server may use as the baseline for the next ones.
+struct AckMsg
+{
+    uint32_t tick = 0;
+};
+
+// Client -> server, reliable: move this client to another match room of
+// the same server. Ignored if that room is full or doesn't exist.
+struct JoinRoomMsg
+{
+    uint32_t room = 0;
+};
+
+struct Packet
+{
+    std::vector<PlayerStateMsg> players;
+    std::vector<BotStateMsg> bots;
+    std::vector<ShotMsg> shots;
+    std::vector<HitMsg> hits;
+    std::vector<InputMsg> inputs;
+    std::vector<WelcomeMsg> welcomes;
+    // At most one per packet.
+    std::vector<SnapshotMsg> snapshots;
+    std::vector<AckMsg> acks;
+    std::vector<JoinRoomMsg> joinRooms;
+
+    [[nodiscard]] bool empty() const
+    {
+        return players.empty() && bots.empty() && shots.empty() && hits.empty() &&
+               inputs.empty() && welcomes.empty() && snapshots.empty() && acks.empty() &&
+               joinRooms.empty();
+    }
+    void clear();
+};
+
+// The last WINDOW_TICKS ticks' snapshots, kept on both ends of a connection
+// as delta baselines: the server stores what it sent, the client what it
+// decoded. A snapshot older than the window has been overwritten.
+class SnapshotHistory
+{
+public:
+    struct Entry
+    {
+        uint32_t tick = 0;
+        std::vector<PlayerStateMsg> players;
+        std::vector<BotStateMsg> bots;
+    };
+
+    void store(uint32_t tick, const std::vector<PlayerStateMsg>& players, const std::vector<BotStateMsg>& bots);
+    [[nodiscard]] const Entry* find(uint32_t tick) const;
+    void clear();
+
+    static constexpr uint32_t WINDOW_TICKS = 64;
+
+private:
+    std::array<Entry, WINDOW_TICKS> entries_;
+};
+
+// The entry with `id` in a list sorted by id, as snapshot lists are, or
+// nullptr.
+template <typename Msg>
+[[nodiscard]] const Msg* findById(const std::vector<Msg>& list, const uint32_t id)
+{
+    const auto it = std::lower_bound(list.begin(), list.end(), id,
+                                     [](const Msg& m, const uint32_t value) { return m.id < value; });
+    return it != list.end() && it->id == id ? &*it : nullptr;
+}
+
+class BitWriter
+{
+public:
+    void writeBits(uint32_t value, int bits);
+    void writeBool(bool value) { writeBits(value ? 1u : 0u, 1); }
+    void writeVarUint(uint32_t value);
+    // Maps [min, max] onto `bits` bits; out-of-range values are clamped.
+    void writeQuantized(float value, float min, float max, int bits);
+
+    [[nodiscard]] const std::vector<uint8_t>& data() const { return bytes_; }
+    [[nodiscard]] std::size_t bitCount() const { return bitPos_; }
+    void clear();
+
+private:
+    std::vector<uint8_t> bytes_;
+    std::size_t bitPos_ = 0;
+};
+
+// Reads past the end yield zeros and set the overflow flag instead of
+// throwing; callers check ok() once after decoding.
+class BitReader
+{
+public:
+    BitReader(const uint8_t* data, std::size_t size);
+
+    uint32_t readBits(int bits);
+    bool readBool() { return readBits(1) != 0; }
+    uint32_t readVarUint();
+    float readQuantized(float min, float max, int bits);
+
+    [[nodiscard]] bool ok() const { return !overflow_; }
+
+private:
+    const uint8_t* data_;
+    std::size_t bitSize_;
+    std::size_t bitPos_ = 0;
+    bool overflow_ = false;
+};
+
+// Sizes, in bits, of the parts of a packet holding one snapshot as
+// encodePacket writes them, for budgeting what goes into it. Records are priced with the id gap
+// their own id would take, the largest it can be, so the sum is an upper
+// bound. An entity unchanged since its baseline costs nothing; pass a null
+// baseline for one the client doesn't have yet.
+[[nodiscard]] std::size_t snapshotHeaderBits(const SnapshotMsg& header);
+[[nodiscard]] std::size_t snapshotEntityBits(const PlayerStateMsg& state, const PlayerStateMsg* baseline);
+[[nodiscard]] std::size_t snapshotEntityBits(const BotStateMsg& state, const BotStateMsg* baseline);
+[[nodiscard]] std::size_t snapshotRemovalBits(uint32_t id);
+
+// A snapshot whose baseTick is missing from `baselines` is sent in full.
+void encodePacket(const Packet& packet, BitWriter& writer, const SnapshotHistory* baselines = nullptr);
+[[nodiscard]] std::vector<uint8_t> encodePacket(const Packet& packet);
+
+// Appends the decoded messages to `out`. Fails on a version mismatch, a
+// truncated packet or a delta snapshot whose baseline is not in `baselines`;
+// `out` may then hold a partial decode.
+bool decodePacket(const uint8_t* data, std::size_t size, Packet& out, const SnapshotHistory* baselines = nullptr);
+
+// A datagram carries one or more frames, each a varint byte length followed
+// by that many bytes, so everything produced in one tick shares one packet.
+void appendFrame(std::vector<uint8_t>& datagram, const uint8_t* data, std::size_t size);
+
+// Calls fn(const uint8_t*, std::size_t) for every frame; false if the
+// datagram is malformed (frames before the damage are still delivered).
+template <typename Fn>
+bool forEachFrame(const uint8_t* data, const std::size_t size, Fn&& fn)
+{
+    std::size_t pos = 0;
+    while (pos < size)
+    {
+        std::size_t length = 0;
+        int shift = 0;
+        for (;;)
+        {
+            if (pos >= size || shift > 28)
+            {
+                return false;
+            }
+
+            const uint8_t byte = data[pos++];
+            length |= static_cast<std::size_t>(byte & 0x7Fu) << shift;
+            shift += 7;
+            if ((byte & 0x80u) == 0)
+            {
+                break;
+            }
+        }
+
+        if (length > size - pos)
+        {
+            return false;
+        }
+
+        fn(data + pos, length);
+        pos += length;
+    }
+    return true;
+}
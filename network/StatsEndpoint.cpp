@@ -0,0 +1,177 @@
+#include <enet/enet.h>
+#include "StatsEndpoint.h"
+
+#include <chrono>
+
+#ifdef _WIN32
+    // winsock2.h comes with enet.h.
+#else
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0
+#endif
+
+// How long a client gets to send its request before the reply goes anyway,
+// and to take the reply before it is cut off.
+static constexpr uint32_t REQUEST_WAIT_MS = 100;
+static constexpr uint32_t SEND_TIMEOUT_MS = 1000;
+
+#ifdef _WIN32
+
+using NativeSocket = SOCKET;
+
+static void closeSocket(const std::intptr_t s)
+{
+    closesocket(static_cast<NativeSocket>(s));
+}
+
+static bool waitReadable(const std::intptr_t s, const uint32_t timeoutMs)
+{
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(static_cast<NativeSocket>(s), &readable);
+
+    timeval timeout{};
+    timeout.tv_sec = static_cast<long>(timeoutMs / 1000);
+    timeout.tv_usec = static_cast<long>((timeoutMs % 1000) * 1000);
+    return select(0, &readable, nullptr, nullptr, &timeout) > 0;
+}
+
+static void setSendTimeout(const std::intptr_t s, const uint32_t timeoutMs)
+{
+    const DWORD timeout = timeoutMs;
+    setsockopt(static_cast<NativeSocket>(s), SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+}
+
+#else
+
+using NativeSocket = int;
+
+static void closeSocket(const std::intptr_t s)
+{
+    ::close(static_cast<NativeSocket>(s));
+}
+
+static bool waitReadable(const std::intptr_t s, const uint32_t timeoutMs)
+{
+    pollfd fd{ static_cast<NativeSocket>(s), POLLIN, 0 };
+    return poll(&fd, 1, static_cast<int>(timeoutMs)) > 0;
+}
+
+static void setSendTimeout(const std::intptr_t s, const uint32_t timeoutMs)
+{
+    timeval timeout{};
+    timeout.tv_sec = static_cast<time_t>(timeoutMs / 1000);
+    timeout.tv_usec = static_cast<suseconds_t>((timeoutMs % 1000) * 1000);
+    setsockopt(static_cast<NativeSocket>(s), SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+#endif
+
+StatsEndpoint::~StatsEndpoint()
+{
+    close();
+}
+
+bool StatsEndpoint::open(const uint16_t port)
+{
+    close();
+
+    const NativeSocket s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (static_cast<std::intptr_t>(s) == -1)
+    {
+        return false;
+    }
+
+#ifndef _WIN32
+    // Lets a restarted server take the port back while old connections
+    // linger in TIME_WAIT. On Windows the same option allows port theft.
+    const int reuse = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#endif
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (bind(s, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(s, 8) != 0)
+    {
+        closeSocket(static_cast<std::intptr_t>(s));
+        return false;
+    }
+
+    socket_ = static_cast<std::intptr_t>(s);
+    return true;
+}
+
+void StatsEndpoint::close()
+{
+    if (socket_ != -1)
+    {
+        closeSocket(socket_);
+    }
+    socket_ = -1;
+}
+
+void StatsEndpoint::serve(const std::string& body, const uint32_t timeoutMs)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    while (true)
+    {
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        if (left <= 0 || !waitReadable(socket_, static_cast<uint32_t>(left)))
+        {
+            return;
+        }
+
+        const auto client = static_cast<std::intptr_t>(accept(static_cast<NativeSocket>(socket_), nullptr, nullptr));
+        if (client != -1)
+        {
+            answer(client, body);
+        }
+    }
+}
+
+void StatsEndpoint::answer(const std::intptr_t client, const std::string& body)
+{
+    // Take the request first: closing with unread data makes the kernel
+    // reset the connection, which can cut the reply short.
+    if (waitReadable(client, REQUEST_WAIT_MS))
+    {
+        char request[1024];
+        recv(static_cast<NativeSocket>(client), request, sizeof(request), 0);
+    }
+
+    std::string reply = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: ";
+    reply += std::to_string(body.size());
+    reply += "\r\nConnection: close\r\n\r\n";
+    reply += body;
+
+    setSendTimeout(client, SEND_TIMEOUT_MS);
+    std::size_t sent = 0;
+    while (sent < reply.size())
+    {
+        const auto n = send(static_cast<NativeSocket>(client), reply.data() + sent, static_cast<int>(reply.size() - sent), MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            break;
+        }
+        sent += static_cast<std::size_t>(n);
+    }
+
+#ifdef _WIN32
+    shutdown(static_cast<NativeSocket>(client), SD_SEND);
+#else
+    shutdown(static_cast<NativeSocket>(client), SHUT_WR);
+#endif
+    closeSocket(client);
+}
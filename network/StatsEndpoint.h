@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// A TCP listener on 127.0.0.1 that answers every connection with the same
+// text, wrapped in a minimal HTTP/1.0 response so `curl` and `nc` both read
+// it. Only reachable from the server's own machine: the stats are for
+// operators and local scrapers, not players.
+class StatsEndpoint
+{
+public:
+    StatsEndpoint() = default;
+    ~StatsEndpoint();
+
+    StatsEndpoint(const StatsEndpoint&) = delete;
+    StatsEndpoint& operator=(const StatsEndpoint&) = delete;
+
+    bool open(uint16_t port);
+    void close();
+    [[nodiscard]] bool isOpen() const { return socket_ != -1; }
+
+    // Answers connections with `body` until `timeoutMs` has passed.
+    void serve(const std::string& body, uint32_t timeoutMs);
+
+private:
+    void answer(std::intptr_t client, const std::string& body);
+
+    std::intptr_t socket_ = -1;
+};
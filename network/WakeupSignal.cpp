@@ -0,0 +1,193 @@
+#include <enet/enet.h>
+#include "WakeupSignal.h"
+
+#ifdef _WIN32
+    // winsock2.h comes with enet.h.
+#else
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <unistd.h>
+    #ifdef __linux__
+        #include <sys/eventfd.h>
+    #endif
+#endif
+
+WakeupSignal::~WakeupSignal()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool WakeupSignal::open()
+{
+    close();
+
+    // A UDP socket connected to itself: sends land in its own receive queue.
+    const SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == INVALID_SOCKET)
+    {
+        return false;
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int length = sizeof(address);
+    u_long nonBlocking = 1;
+    if (bind(s, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        getsockname(s, reinterpret_cast<sockaddr*>(&address), &length) != 0 ||
+        connect(s, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ioctlsocket(s, FIONBIO, &nonBlocking) != 0)
+    {
+        closesocket(s);
+        return false;
+    }
+
+    readHandle_ = writeHandle_ = static_cast<std::intptr_t>(s);
+    return true;
+}
+
+void WakeupSignal::close()
+{
+    if (readHandle_ != -1)
+    {
+        closesocket(static_cast<SOCKET>(readHandle_));
+    }
+    readHandle_ = writeHandle_ = -1;
+    pending_ = false;
+}
+
+void WakeupSignal::signal()
+{
+    if (writeHandle_ == -1 || pending_.exchange(true))
+    {
+        return;
+    }
+    const char byte = 1;
+    send(static_cast<SOCKET>(writeHandle_), &byte, 1, 0);
+}
+
+void WakeupSignal::drain()
+{
+    char buffer[64];
+    while (recv(static_cast<SOCKET>(readHandle_), buffer, sizeof(buffer), 0) > 0)
+    {
+    }
+}
+
+void WakeupSignal::wait(const _ENetHost* host, const uint32_t timeoutMs)
+{
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(host->socket, &readable);
+    if (readHandle_ != -1)
+    {
+        FD_SET(static_cast<SOCKET>(readHandle_), &readable);
+    }
+
+    timeval timeout{};
+    timeout.tv_sec = static_cast<long>(timeoutMs / 1000);
+    timeout.tv_usec = static_cast<long>((timeoutMs % 1000) * 1000);
+    select(0, &readable, nullptr, nullptr, &timeout);
+
+    if (readHandle_ != -1 && FD_ISSET(static_cast<SOCKET>(readHandle_), &readable))
+    {
+        // Empty the socket before clearing the flag: a signal() racing with
+        // this either sees the flag still set (and its data is picked up by
+        // the caller's next pass) or writes again.
+        drain();
+        pending_ = false;
+    }
+}
+
+#else
+
+bool WakeupSignal::open()
+{
+    close();
+
+#ifdef __linux__
+    const int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    readHandle_ = writeHandle_ = fd;
+#else
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return false;
+    }
+    for (const int fd : fds)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    readHandle_ = fds[0];
+    writeHandle_ = fds[1];
+#endif
+    return true;
+}
+
+void WakeupSignal::close()
+{
+    if (writeHandle_ != -1 && writeHandle_ != readHandle_)
+    {
+        ::close(static_cast<int>(writeHandle_));
+    }
+    if (readHandle_ != -1)
+    {
+        ::close(static_cast<int>(readHandle_));
+    }
+    readHandle_ = writeHandle_ = -1;
+    pending_ = false;
+}
+
+void WakeupSignal::signal()
+{
+    if (writeHandle_ == -1 || pending_.exchange(true))
+    {
+        return;
+    }
+#ifdef __linux__
+    const uint64_t one = 1;
+    (void)!write(static_cast<int>(writeHandle_), &one, sizeof(one));
+#else
+    const char byte = 1;
+    (void)!write(static_cast<int>(writeHandle_), &byte, 1);
+#endif
+}
+
+void WakeupSignal::drain()
+{
+    uint64_t buffer[8];
+    while (read(static_cast<int>(readHandle_), buffer, sizeof(buffer)) > 0)
+    {
+    }
+}
+
+void WakeupSignal::wait(const _ENetHost* host, const uint32_t timeoutMs)
+{
+    pollfd fds[2] = {
+        { host->socket, POLLIN, 0 },
+        { static_cast<int>(readHandle_), POLLIN, 0 },
+    };
+    const nfds_t count = readHandle_ != -1 ? 2 : 1;
+    if (poll(fds, count, static_cast<int>(timeoutMs)) <= 0)
+    {
+        return;
+    }
+
+    if (count == 2 && (fds[1].revents & POLLIN))
+    {
+        // Empty the fd before clearing the flag: a signal() racing with
+        // this either sees the flag still set (and its data is picked up by
+        // the caller's next pass) or writes again.
+        drain();
+        pending_ = false;
+    }
+}
+
+#endif
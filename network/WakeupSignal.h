@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+struct _ENetHost;
+
+// Lets other threads interrupt a service thread blocked on its ENet socket.
+// The service thread sleeps until either the socket or this signal becomes
+// readable, so a flushed batch leaves right away instead of when a poll
+// timeout runs out. An eventfd on Linux, a self-pipe on other POSIX systems
+// and a loopback UDP socket on Windows, whose select() only takes sockets.
+class WakeupSignal
+{
+public:
+    WakeupSignal() = default;
+    ~WakeupSignal();
+
+    WakeupSignal(const WakeupSignal&) = delete;
+    WakeupSignal& operator=(const WakeupSignal&) = delete;
+
+    bool open();
+    void close();
+
+    // Any thread. Cheap when a wakeup is already pending.
+    void signal();
+
+    // Service thread: blocks until `host`'s socket is readable, signal() is
+    // called or `timeoutMs` passes, and consumes any pending signal.
+    void wait(const _ENetHost* host, uint32_t timeoutMs);
+
+private:
+    void drain();
+
+    std::intptr_t readHandle_ = -1;
+    std::intptr_t writeHandle_ = -1;
+    std::atomic<bool> pending_{false};
+};
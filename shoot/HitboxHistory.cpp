@@ -0,0 +1,127 @@
+#include "HitboxHistory.h"
+
+#include <algorithm>
+#include <cmath>
+
+static Rectangle Union(const Rectangle& a, const Rectangle& b)
+{
+    const float x = fminf(a.x, b.x);
+    const float y = fminf(a.y, b.y);
+    return { x, y, fmaxf(a.x + a.width, b.x + b.width) - x, fmaxf(a.y + a.height, b.y + b.height) - y };
+}
+
+static bool Overlaps(const Rectangle& a, const Rectangle& b)
+{
+    return a.x <= b.x + b.width && b.x <= a.x + a.width && a.y <= b.y + b.height && b.y <= a.y + a.height;
+}
+
+HitboxHistory::HitboxHistory(const std::size_t capacity)
+    : frames(capacity > 0 ? capacity : 1) {}
+
+void HitboxHistory::SetCapacity(const std::size_t capacity)
+{
+    if (capacity == frames.size() || capacity == 0) return;
+
+    frames.assign(capacity, Frame{});
+    Clear();
+}
+
+void HitboxHistory::Clear()
+{
+    head = 0;
+    count = 0;
+    envelopeIds.clear();
+    envelopes.clear();
+    grid.Clear();
+    maxHalfExtent = {};
+}
+
+const HitboxHistory::Frame& HitboxHistory::Back(const std::size_t ticksAgo) const
+{
+    const std::size_t back = std::min(ticksAgo, count - 1);
+    return frames[(head + count - 1 - back) % frames.size()];
+}
+
+void HitboxHistory::Store(const std::vector<HitTarget>& targets)
+{
+    Frame* frame;
+    if (count < frames.size())
+    {
+        frame = &frames[(head + count) % frames.size()];
+        ++count;
+    }
+    else
+    {
+        frame = &frames[head];
+        head = (head + 1) % frames.size();
+    }
+
+    frame->targets.assign(targets.begin(), targets.end());
+    std::sort(frame->targets.begin(), frame->targets.end(),
+              [](const HitTarget& a, const HitTarget& b) { return a.actorId < b.actorId; });
+
+    RebuildEnvelopes();
+}
+
+void HitboxHistory::RebuildEnvelopes()
+{
+    envelopeIds.clear();
+    envelopes.clear();
+
+    // Newest frame first: it usually lists every actor, so later frames
+    // mostly grow existing envelopes instead of inserting.
+    for (std::size_t back = 0; back < count; ++back)
+    {
+        for (const HitTarget& target : Back(back).targets)
+        {
+            const auto it = std::lower_bound(envelopeIds.begin(), envelopeIds.end(), target.actorId);
+            const auto index = it - envelopeIds.begin();
+            if (it != envelopeIds.end() && *it == target.actorId)
+            {
+                envelopes[index] = Union(envelopes[index], target.rect);
+            }
+            else
+            {
+                envelopeIds.insert(it, target.actorId);
+                envelopes.insert(envelopes.begin() + index, target.rect);
+            }
+        }
+    }
+
+    grid.Clear();
+    maxHalfExtent = {};
+    for (const Rectangle& e : envelopes)
+    {
+        grid.Add({ e.x + e.width * 0.5f, e.y + e.height * 0.5f });
+        maxHalfExtent.x = fmaxf(maxHalfExtent.x, e.width * 0.5f);
+        maxHalfExtent.y = fmaxf(maxHalfExtent.y, e.height * 0.5f);
+    }
+    grid.Build();
+}
+
+void HitboxHistory::Query(const std::uint32_t ticksAgo, const Rectangle& area, std::vector<HitTarget>& out) const
+{
+    out.clear();
+    if (count == 0) return;
+
+    // An envelope overlapping `area` has its centre within its half extent
+    // of it, and no envelope is wider than the widest.
+    const Rectangle search = { area.x - maxHalfExtent.x, area.y - maxHalfExtent.y,
+                               area.width + maxHalfExtent.x * 2.0f, area.height + maxHalfExtent.y * 2.0f };
+    grid.Query(search, candidates);
+    if (candidates.empty()) return;
+
+    const std::vector<HitTarget>& targets = Back(ticksAgo).targets;
+    for (const int c : candidates)
+    {
+        if (!Overlaps(envelopes[c], area)) continue;
+
+        const std::uint32_t id = envelopeIds[c];
+        const auto it = std::lower_bound(targets.begin(), targets.end(), id,
+                                         [](const HitTarget& t, const std::uint32_t v) { return t.actorId < v; });
+        if (it != targets.end() && it->actorId == id && Overlaps(it->rect, area))
+        {
+            out.push_back(*it);
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "raylib.h"
+#include "InterestGrid.h"
+#include "ProjectileSystem.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Every actor's hitbox for the last few hundred milliseconds, one frame per
+// tick, so a shot can be tested against the world its shooter was looking
+// at rather than the one the server has moved on to. Queries go through a
+// grid over each actor's bounds across the whole window first; only actors
+// that pass it are looked up in the rewound frame.
+class HitboxHistory
+{
+public:
+    explicit HitboxHistory(std::size_t capacity = 32);
+
+    // Frames kept; changing it drops the history.
+    void SetCapacity(std::size_t capacity);
+    [[nodiscard]] std::size_t Capacity() const { return frames.size(); }
+    [[nodiscard]] std::size_t Count() const { return count; }
+
+    void Clear();
+
+    // Records one tick's hitboxes as the newest frame.
+    void Store(const std::vector<HitTarget>& targets);
+
+    // Targets `ticksAgo` frames before the newest one (clamped to the oldest
+    // frame kept) whose rect overlaps `area`, in actor id order.
+    void Query(std::uint32_t ticksAgo, const Rectangle& area, std::vector<HitTarget>& out) const;
+
+private:
+    struct Frame
+    {
+        // Sorted by actorId.
+        std::vector<HitTarget> targets;
+    };
+
+    [[nodiscard]] const Frame& Back(std::size_t ticksAgo) const;
+    void RebuildEnvelopes();
+
+    std::vector<Frame> frames;
+    std::size_t head = 0;
+    std::size_t count = 0;
+
+    // Union of each actor's rects over the window, by actor id.
+    std::vector<std::uint32_t> envelopeIds;
+    std::vector<Rectangle> envelopes;
+    InterestGrid grid{ 128.0f };
+    Vector2 maxHalfExtent{};
+    mutable std::vector<int> candidates;
+};
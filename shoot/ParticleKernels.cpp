@@ -0,0 +1,188 @@
+#include "ParticleKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+    #define WAR_HAS_SSE2 1
+    #include <emmintrin.h>
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define WAR_TARGET_AVX2
+    #else
+        #define WAR_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+static constexpr float PARTICLE_DAMPING = 0.98f;
+static constexpr float PARTICLE_GRAVITY = 80.0f;
+
+void IntegrateParticlesScalar(const ParticleSpan &span, const float delta)
+{
+    const float gravity = PARTICLE_GRAVITY * delta;
+
+    for (std::size_t i = 0; i < span.count; ++i)
+    {
+        const float vx = span.velX[i] * PARTICLE_DAMPING;
+        const float vy = span.velY[i] * PARTICLE_DAMPING + gravity;
+
+        span.velX[i] = vx;
+        span.velY[i] = vy;
+        span.posX[i] += vx * delta;
+        span.posY[i] += vy * delta;
+
+        const float l = span.life[i] - delta;
+        span.life[i] = l;
+        span.dead[i] = l <= 0.0f ? 1 : 0;
+    }
+}
+
+#if defined(WAR_HAS_SSE2)
+
+void IntegrateParticlesSSE2(const ParticleSpan &span, const float delta)
+{
+    const __m128 damping = _mm_set1_ps(PARTICLE_DAMPING);
+    const __m128 gravity = _mm_set1_ps(PARTICLE_GRAVITY * delta);
+    const __m128 dt = _mm_set1_ps(delta);
+    const __m128 zero = _mm_setzero_ps();
+
+    std::size_t i = 0;
+    for (; i + 4 <= span.count; i += 4)
+    {
+        const __m128 vx = _mm_mul_ps(_mm_loadu_ps(span.velX + i), damping);
+        const __m128 vy = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(span.velY + i), damping), gravity);
+
+        _mm_storeu_ps(span.velX + i, vx);
+        _mm_storeu_ps(span.velY + i, vy);
+        _mm_storeu_ps(span.posX + i, _mm_add_ps(_mm_loadu_ps(span.posX + i), _mm_mul_ps(vx, dt)));
+        _mm_storeu_ps(span.posY + i, _mm_add_ps(_mm_loadu_ps(span.posY + i), _mm_mul_ps(vy, dt)));
+
+        const __m128 l = _mm_sub_ps(_mm_loadu_ps(span.life + i), dt);
+        _mm_storeu_ps(span.life + i, l);
+
+        const int mask = _mm_movemask_ps(_mm_cmple_ps(l, zero));
+        span.dead[i + 0] = static_cast<std::uint8_t>(mask & 1);
+        span.dead[i + 1] = static_cast<std::uint8_t>((mask >> 1) & 1);
+        span.dead[i + 2] = static_cast<std::uint8_t>((mask >> 2) & 1);
+        span.dead[i + 3] = static_cast<std::uint8_t>((mask >> 3) & 1);
+    }
+
+    const ParticleSpan tail = {
+        span.posX + i, span.posY + i, span.velX + i, span.velY + i,
+        span.life + i, span.dead + i, span.count - i
+    };
+    IntegrateParticlesScalar(tail, delta);
+}
+
+WAR_TARGET_AVX2 void IntegrateParticlesAVX2(const ParticleSpan &span, const float delta)
+{
+    const __m256 damping = _mm256_set1_ps(PARTICLE_DAMPING);
+    const __m256 gravity = _mm256_set1_ps(PARTICLE_GRAVITY * delta);
+    const __m256 dt = _mm256_set1_ps(delta);
+    const __m256 zero = _mm256_setzero_ps();
+
+    std::size_t i = 0;
+    for (; i + 8 <= span.count; i += 8)
+    {
+        const __m256 vx = _mm256_mul_ps(_mm256_loadu_ps(span.velX + i), damping);
+        const __m256 vy = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(span.velY + i), damping), gravity);
+
+        _mm256_storeu_ps(span.velX + i, vx);
+        _mm256_storeu_ps(span.velY + i, vy);
+        _mm256_storeu_ps(span.posX + i, _mm256_add_ps(_mm256_loadu_ps(span.posX + i), _mm256_mul_ps(vx, dt)));
+        _mm256_storeu_ps(span.posY + i, _mm256_add_ps(_mm256_loadu_ps(span.posY + i), _mm256_mul_ps(vy, dt)));
+
+        const __m256 l = _mm256_sub_ps(_mm256_loadu_ps(span.life + i), dt);
+        _mm256_storeu_ps(span.life + i, l);
+
+        const int mask = _mm256_movemask_ps(_mm256_cmp_ps(l, zero, _CMP_LE_OQ));
+        for (int k = 0; k < 8; ++k)
+        {
+            span.dead[i + k] = static_cast<std::uint8_t>((mask >> k) & 1);
+        }
+    }
+
+    const ParticleSpan tail = {
+        span.posX + i, span.posY + i, span.velX + i, span.velY + i,
+        span.life + i, span.dead + i, span.count - i
+    };
+    IntegrateParticlesSSE2(tail, delta);
+}
+
+static bool CpuSupportsAVX2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+        return false;
+    }
+
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#else
+
+void IntegrateParticlesSSE2(const ParticleSpan &span, const float delta)
+{
+    IntegrateParticlesScalar(span, delta);
+}
+
+void IntegrateParticlesAVX2(const ParticleSpan &span, const float delta)
+{
+    IntegrateParticlesScalar(span, delta);
+}
+
+static bool CpuSupportsAVX2()
+{
+    return false;
+}
+
+#endif
+
+SimdLevel DetectSimdLevel()
+{
+#if defined(WAR_HAS_SSE2)
+    static const SimdLevel level = CpuSupportsAVX2() ? SimdLevel::AVX2 : SimdLevel::SSE2;
+    return level;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+const char *SimdLevelName(const SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::SSE2: return "sse2";
+        case SimdLevel::AVX2: return "avx2";
+        default:              return "scalar";
+    }
+}
+
+ParticleIntegrateFn SelectParticleKernel(SimdLevel level)
+{
+    if (level > DetectSimdLevel())
+    {
+        level = DetectSimdLevel();
+    }
+
+    switch (level)
+    {
+        case SimdLevel::AVX2: return IntegrateParticlesAVX2;
+        case SimdLevel::SSE2: return IntegrateParticlesSSE2;
+        default:              return IntegrateParticlesScalar;
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Raw view over the SoA arrays owned by ParticleSystem. Every array holds at
+// least `count` elements; `dead` receives 1 for each particle whose life ran out.
+struct ParticleSpan
+{
+    float *posX;
+    float *posY;
+    float *velX;
+    float *velY;
+    float *life;
+    std::uint8_t *dead;
+    std::size_t count;
+};
+
+enum class SimdLevel { Scalar = 0, SSE2, AVX2 };
+
+using ParticleIntegrateFn = void(*)(const ParticleSpan &span, float delta);
+
+// Advances every particle by one step: damping, gravity, position and life.
+void IntegrateParticlesScalar(const ParticleSpan &span, float delta);
+void IntegrateParticlesSSE2(const ParticleSpan &span, float delta);
+void IntegrateParticlesAVX2(const ParticleSpan &span, float delta);
+
+[[nodiscard]] SimdLevel DetectSimdLevel();
+[[nodiscard]] const char *SimdLevelName(SimdLevel level);
+
+// Returns the kernel for `level`, falling back to the best supported one below it.
+[[nodiscard]] ParticleIntegrateFn SelectParticleKernel(SimdLevel level);
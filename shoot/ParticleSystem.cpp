@@ -0,0 +1,101 @@
+#include "ParticleSystem.h"
+#include "ShapeBatch.h"
+#include "raylib.h"
+
+#include <cmath>
+
+ParticleSystem::ParticleSystem(const std::size_t capacity)
+    : capacity(capacity),
+      posX(capacity), posY(capacity),
+      velX(capacity), velY(capacity),
+      life(capacity), radius(capacity),
+      color(capacity), dead(capacity),
+      simdLevel(DetectSimdLevel()),
+      integrate(SelectParticleKernel(simdLevel)) {}
+
+void ParticleSystem::Emit(const Vector2 &pos, const Vector2 &vel, const float lifeTime, const float r, const Color c)
+{
+    if (capacity == 0)
+    {
+        return;
+    }
+
+    // When the pool is saturated recycle slots round-robin instead of growing.
+    std::size_t i;
+    if (count < capacity)
+    {
+        i = count++;
+    }
+    else
+    {
+        i = overwriteCursor;
+        overwriteCursor = (overwriteCursor + 1) % capacity;
+    }
+
+    posX[i] = pos.x;
+    posY[i] = pos.y;
+    velX[i] = vel.x;
+    velY[i] = vel.y;
+    life[i] = lifeTime;
+    radius[i] = r;
+    color[i] = c;
+}
+
+void ParticleSystem::Update(const float delta)
+{
+    const ParticleSpan span = {
+        posX.data(), posY.data(), velX.data(), velY.data(),
+        life.data(), dead.data(), count
+    };
+    integrate(span, delta);
+
+    std::size_t alive = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (dead[i])
+        {
+            continue;
+        }
+
+        if (alive != i)
+        {
+            posX[alive] = posX[i];
+            posY[alive] = posY[i];
+            velX[alive] = velX[i];
+            velY[alive] = velY[i];
+            life[alive] = life[i];
+            radius[alive] = radius[i];
+            color[alive] = color[i];
+        }
+        ++alive;
+    }
+
+    count = alive;
+    if (overwriteCursor >= count)
+    {
+        overwriteCursor = 0;
+    }
+}
+
+void ParticleSystem::Draw(ShapeBatch &batch) const
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const float alpha = fminf(fmaxf(0.0f, life[i] / 1.0f), 1.0f);
+        Color c = color[i];
+        c.a = static_cast<unsigned char>(255.0f * alpha);
+        batch.AddCircle(Vector2{ posX[i], posY[i] }, radius[i], c);
+    }
+}
+
+void ParticleSystem::Clear()
+{
+    count = 0;
+    overwriteCursor = 0;
+}
+
+void ParticleSystem::SetSimdLevel(const SimdLevel level)
+{
+    integrate = SelectParticleKernel(level);
+    simdLevel = level > DetectSimdLevel() ? DetectSimdLevel() : level;
+}
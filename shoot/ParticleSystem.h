@@ -0,0 +1,44 @@
+#pragma once
+
+#include "raylib.h"
+#include "ParticleKernels.h"
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class ShapeBatch;
+
+class ParticleSystem
+{
+public:
+    explicit ParticleSystem(std::size_t capacity = 16384);
+
+    void Emit(const Vector2 &pos, const Vector2 &vel, float life, float radius, Color color);
+    void Update(float delta);
+    void Draw(ShapeBatch &batch) const;
+    void Clear();
+
+    void SetSimdLevel(SimdLevel level);
+    [[nodiscard]] SimdLevel GetSimdLevel() const { return simdLevel; }
+
+    [[nodiscard]] std::size_t Count() const { return count; }
+    [[nodiscard]] std::size_t Capacity() const { return capacity; }
+
+private:
+    std::size_t capacity;
+    std::size_t count = 0;
+    std::size_t overwriteCursor = 0;
+
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<float> velX;
+    std::vector<float> velY;
+    std::vector<float> life;
+    std::vector<float> radius;
+    std::vector<Color> color;
+    std::vector<std::uint8_t> dead;
+
+    SimdLevel simdLevel;
+    ParticleIntegrateFn integrate;
+};
@@ -0,0 +1,232 @@
+#include "ProjectileSystem.h"
+#include "EnvIndex.h"
+#include "HitboxHistory.h"
+#include "Collision.h"
+#include "ParticleSystem.h"
+#include "ShapeBatch.h"
+#include "raylib.h"
+
+#include <cmath>
+#include <functional>
+#include <random>
+#include <thread>
+
+static float RandomFloat(const float a, const float b)
+{
+    // The thread id keeps workers apart where random_device is deterministic.
+    static thread_local std::mt19937 rng(
+        std::random_device{}() ^ static_cast<unsigned>(std::hash<std::thread::id>{}(std::this_thread::get_id())));
+    std::uniform_real_distribution dist(a, b);
+    return dist(rng);
+}
+
+ProjectileSystem::ProjectileSystem(const std::size_t capacity)
+    : capacity(capacity),
+      posX(capacity), posY(capacity),
+      prevX(capacity), prevY(capacity),
+      velX(capacity), velY(capacity),
+      owner(capacity), team(capacity), damage(capacity), rewind(capacity),
+      denseToSlot(capacity),
+      slotToDense(capacity), generation(capacity, 0)
+{
+    freeSlots.reserve(capacity);
+    for (std::size_t i = capacity; i > 0; --i)
+    {
+        freeSlots.push_back(static_cast<std::uint32_t>(i - 1));
+    }
+}
+
+ProjectileHandle ProjectileSystem::Spawn(const std::uint32_t ownerId, const std::uint8_t ownerTeam,
+                                         const Vector2 &pos, const Vector2 &vel, const int dmg,
+                                         const std::uint16_t rewindTicks)
+{
+    if (freeSlots.empty())
+    {
+        return {};
+    }
+
+    const std::uint32_t slot = freeSlots.back();
+    freeSlots.pop_back();
+
+    const std::size_t i = count++;
+    posX[i] = pos.x;
+    posY[i] = pos.y;
+    prevX[i] = pos.x;
+    prevY[i] = pos.y;
+    velX[i] = vel.x;
+    velY[i] = vel.y;
+    owner[i] = ownerId;
+    team[i] = ownerTeam;
+    damage[i] = dmg;
+    rewind[i] = rewindTicks;
+    denseToSlot[i] = slot;
+    slotToDense[slot] = static_cast<std::uint32_t>(i);
+
+    spawnLog.push_back({ ownerId, pos, vel });
+    return { slot, generation[slot] };
+}
+
+bool ProjectileSystem::IsAlive(const ProjectileHandle handle) const
+{
+    return handle.IsValid() && handle.slot < capacity && generation[handle.slot] == handle.generation;
+}
+
+void ProjectileSystem::Despawn(const ProjectileHandle handle)
+{
+    if (IsAlive(handle))
+    {
+        RemoveAt(slotToDense[handle.slot]);
+    }
+}
+
+void ProjectileSystem::RemoveAt(const std::size_t index)
+{
+    const std::uint32_t slot = denseToSlot[index];
+    ++generation[slot];
+    freeSlots.push_back(slot);
+
+    const std::size_t last = --count;
+    if (index != last)
+    {
+        posX[index] = posX[last];
+        posY[index] = posY[last];
+        prevX[index] = prevX[last];
+        prevY[index] = prevY[last];
+        velX[index] = velX[last];
+        velY[index] = velY[last];
+        owner[index] = owner[last];
+        team[index] = team[last];
+        damage[index] = damage[last];
+        rewind[index] = rewind[last];
+        denseToSlot[index] = denseToSlot[last];
+        slotToDense[denseToSlot[index]] = static_cast<std::uint32_t>(index);
+    }
+}
+
+void ProjectileSystem::EmitBurst(const Vector2 pos, ParticleSystem &particles)
+{
+    constexpr int count = 10;
+    for (int i = 0; i < count; ++i)
+    {
+        const float ang = RandomFloat(0.0f, 2.0f * PI);
+        const float spd = RandomFloat(40.0f, 240.0f);
+
+        const Vector2 v = { cosf(ang) * spd, sinf(ang) * spd };
+        particles.Emit(pos, v, RandomFloat(0.3f, 0.9f), RandomFloat(1.0f, 3.0f), DARKGRAY);
+    }
+}
+
+void ProjectileSystem::Update(const float delta, const EnvIndex &env,
+                              const std::vector<HitTarget> &targets, ParticleSystem &particles,
+                              std::vector<ProjectileHit> &outHits, const HitboxHistory *history)
+{
+    std::size_t i = 0;
+    while (i < count)
+    {
+        const Vector2 from = { posX[i], posY[i] };
+        const Vector2 to = { posX[i] + velX[i] * delta, posY[i] + velY[i] * delta };
+        const Rectangle bounds = SweepBounds(from, to, RADIUS);
+
+        float firstT = 2.0f;
+        const HitTarget *firstTarget = nullptr;
+
+        if (const float t = env.SweepCircle(from, to, RADIUS); t >= 0.0f)
+        {
+            firstT = t;
+        }
+
+        const std::vector<HitTarget> *candidates = &targets;
+        if (history)
+        {
+            history->Query(rewind[i], bounds, rewound);
+            candidates = &rewound;
+        }
+
+        for (const auto &target : *candidates)
+        {
+            if (target.team == team[i] || target.actorId == owner[i] || !CheckCollisionRecs(bounds, target.rect))
+            {
+                continue;
+            }
+            if (const float t = SweepCircleRect(from, to, RADIUS, target.rect); t >= 0.0f && t <= firstT)
+            {
+                firstT = t;
+                firstTarget = &target;
+            }
+        }
+
+        const float travel = firstT < 1.0f ? firstT : 1.0f;
+        const float segX = (to.x - from.x) * travel;
+        const float segY = (to.y - from.y) * travel;
+
+        prevX[i] = from.x;
+        prevY[i] = from.y;
+        posX[i] = from.x + segX;
+        posY[i] = from.y + segY;
+
+        if (const float segLen = sqrtf(segX * segX + segY * segY); segLen > 0.0001f)
+        {
+            constexpr float spacing = 6.0f;
+            const int steps = static_cast<int>(ceilf(segLen / spacing));
+            const Vector2 pVel = { velX[i] * -0.02f, velY[i] * -0.02f };
+            for (int s = 0; s < steps; ++s)
+            {
+                const float t = static_cast<float>(s) / static_cast<float>(steps);
+                const Vector2 p = { from.x + segX * t, from.y + segY * t };
+                particles.Emit(p, pVel, RandomFloat(0.18f, 0.45f), RandomFloat(0.9f, 1.8f), WHITE);
+            }
+        }
+
+        const Vector2 pos = { posX[i], posY[i] };
+        bool dead = false;
+
+        if (firstT <= 1.0f)
+        {
+            if (firstTarget)
+            {
+                outHits.push_back({ owner[i], firstTarget->actorId, damage[i], pos });
+            }
+            EmitBurst(pos, particles);
+            dead = true;
+        }
+        else if (pos.x < -WORLD_LIMIT || pos.x > WORLD_LIMIT || pos.y < -WORLD_LIMIT || pos.y > WORLD_LIMIT)
+        {
+            dead = true;
+        }
+
+        if (dead)
+        {
+            RemoveAt(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+void ProjectileSystem::Draw(ShapeBatch &batch, const float alpha) const
+{
+    constexpr float len = 12.0f;
+    constexpr float halfLen = len * 0.5f;
+    constexpr float thickness = RADIUS * 2.0f;
+    const Vector2 origin = { halfLen, thickness * 0.5f };
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const float rot = atan2f(velY[i], velX[i]) * 180.0f / PI;
+        const float x = prevX[i] + (posX[i] - prevX[i]) * alpha;
+        const float y = prevY[i] + (posY[i] - prevY[i]) * alpha;
+        const Rectangle rec = { x - halfLen, y - thickness * 0.5f, len, thickness };
+        batch.AddRectPro(rec, origin, rot, DARKGRAY);
+    }
+}
+
+void ProjectileSystem::Clear()
+{
+    while (count > 0)
+    {
+        RemoveAt(count - 1);
+    }
+    spawnLog.clear();
+}
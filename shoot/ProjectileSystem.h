@@ -0,0 +1,103 @@
+#pragma once
+
+#include "raylib.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class EnvIndex;
+class HitboxHistory;
+class ParticleSystem;
+class ShapeBatch;
+
+struct ProjectileHandle
+{
+    std::uint32_t slot = UINT32_MAX;
+    std::uint32_t generation = 0;
+
+    [[nodiscard]] bool IsValid() const { return slot != UINT32_MAX; }
+};
+
+struct HitTarget
+{
+    std::uint32_t actorId;
+    std::uint8_t team;
+    Rectangle rect;
+};
+
+struct ProjectileHit
+{
+    std::uint32_t ownerId;
+    std::uint32_t targetId;
+    int damage;
+    Vector2 point;
+};
+
+struct ProjectileSpawn
+{
+    std::uint32_t ownerId;
+    Vector2 pos;
+    Vector2 vel;
+};
+
+// Every bullet in flight lives here, independent of the weapon that fired it.
+// Storage is dense SoA; handles stay valid across swap-and-pop removals.
+class ProjectileSystem
+{
+public:
+    explicit ProjectileSystem(std::size_t capacity = 4096);
+
+    // `rewindTicks` is how far behind the server its shooter saw the world;
+    // with a hitbox history the projectile is tested against targets that
+    // many ticks in the past for its whole flight.
+    ProjectileHandle Spawn(std::uint32_t ownerId, std::uint8_t team,
+                           const Vector2 &pos, const Vector2 &vel, int damage,
+                           std::uint16_t rewindTicks = 0);
+    void Despawn(ProjectileHandle handle);
+    [[nodiscard]] bool IsAlive(ProjectileHandle handle) const;
+
+    // Moves every projectile and sweeps it against geometry and `targets`;
+    // the earliest contact along the step wins. Given a `history` whose
+    // newest frame is `targets`, targets come from it instead, rewound
+    // per projectile.
+    void Update(float delta, const EnvIndex &env,
+                const std::vector<HitTarget> &targets, ParticleSystem &particles,
+                std::vector<ProjectileHit> &outHits, const HitboxHistory *history = nullptr);
+    void Draw(ShapeBatch &batch, float alpha = 1.0f) const;
+    void Clear();
+
+    [[nodiscard]] std::size_t Count() const { return count; }
+
+    // Every Spawn since the last ClearSpawnLog, for replicating shots.
+    [[nodiscard]] const std::vector<ProjectileSpawn> &SpawnLog() const { return spawnLog; }
+    void ClearSpawnLog() { spawnLog.clear(); }
+
+private:
+    void RemoveAt(std::size_t index);
+    static void EmitBurst(Vector2 pos, ParticleSystem &particles);
+
+    static constexpr float RADIUS = 4.0f;
+    static constexpr float WORLD_LIMIT = 5000.0f;
+
+    std::size_t capacity;
+    std::size_t count = 0;
+
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<float> prevX;
+    std::vector<float> prevY;
+    std::vector<float> velX;
+    std::vector<float> velY;
+    std::vector<std::uint32_t> owner;
+    std::vector<std::uint8_t> team;
+    std::vector<int> damage;
+    std::vector<std::uint16_t> rewind;
+    std::vector<std::uint32_t> denseToSlot;
+
+    std::vector<std::uint32_t> slotToDense;
+    std::vector<std::uint32_t> generation;
+    std::vector<std::uint32_t> freeSlots;
+
+    std::vector<ProjectileSpawn> spawnLog;
+    std::vector<HitTarget> rewound;
+};
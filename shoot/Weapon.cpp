@@ -1,17 +1,21 @@
 #include "Weapon.h"
 #include "raylib.h"
-#include "Game.h"
-#include "Particle.h"
+#include "ProjectileSystem.h"
+#include "ShapeBatch.h"
 
 #include <cmath>
+#include <functional>
 #include <random>
-#include <ctime>
+#include <thread>
 
 #include "raymath.h"
 
 static float RandomFloatW(const float a, const float b)
 {
-    static std::mt19937 rng(static_cast<unsigned>(time(nullptr)));
+    // Seeded per thread: room workers started in the same second must not
+    // share a spread pattern.
+    static thread_local std::mt19937 rng(
+        std::random_device{}() ^ static_cast<unsigned>(std::hash<std::thread::id>{}(std::this_thread::get_id())));
     std::uniform_real_distribution<float> dist(a, b);
     return dist(rng);
 }
@@ -27,11 +31,18 @@ static Vector2 RandomPointInCircleW(const Vector2 &center, const float r)
 
 Weapon::Weapon(const float length, const float thickness, const float bulletSpeed, const float cooldown)
     : anchor{0.0f, 0.0f}, length(length), thickness(thickness), rotationDegrees(0.0f),
-      cooldown(cooldown), cooldownTimer(0.0f), bulletSpeed(bulletSpeed), bullets() {}
+      cooldown(cooldown), cooldownTimer(0.0f), bulletSpeed(bulletSpeed) {}
+
+void Weapon::SetOwner(const std::uint32_t id, const std::uint8_t ownerTeam, const int bulletDamage)
+{
+    ownerId = id;
+    team = ownerTeam;
+    damage = bulletDamage;
+}
 
 void Weapon::Update(const float delta, const Vector2 &anchorPos, const Vector2 &targetPos,
-    const std::vector<EnvItem> &envItems, std::vector<Particle> &outParticles,
-    const float spreadRadius, const bool forceFire)
+    ProjectileSystem &projectiles, const float spreadRadius, const bool fire,
+    const std::uint16_t rewindTicks)
 {
     anchor = anchorPos;
 
@@ -45,7 +56,7 @@ void Weapon::Update(const float delta, const Vector2 &anchorPos, const Vector2 &
         cooldownTimer -= delta;
     }
 
-    if ((IsMouseButtonDown(MOUSE_LEFT_BUTTON) || forceFire) && cooldownTimer <= 0.0f)
+    if (fire && cooldownTimer <= 0.0f)
     {
         const float rad = rotationDegrees * PI / 180.0f;
         const Vector2 endPos = { anchor.x + cosf(rad) * length, anchor.y + sinf(rad) * length };
@@ -68,48 +79,19 @@ void Weapon::Update(const float delta, const Vector2 &anchorPos, const Vector2 &
             vel = { bulletSpeed, 0 };
         }
 
-        bullets.emplace_back(endPos, vel, 0.0f);
+        projectiles.Spawn(ownerId, team, endPos, vel, damage, rewindTicks);
         cooldownTimer = cooldown;
     }
-
-    for (auto it = bullets.begin(); it != bullets.end(); )
-    {
-        if (!it->Update(delta, envItems, outParticles))
-        {
-            it = bullets.erase(it);
-        }
-        else
-        {
-            ++it;
-        }
-    }
 }
 
-int Weapon::CheckHit(const Rectangle target, std::vector<Particle> &outParticles)
+void Weapon::Draw(ShapeBatch &batch, const Vector2 offset) const
 {
-    int hits = 0;
-    for (auto &b : bullets)
-    {
-        if (b.TryHit(target, outParticles))
-        {
-            ++hits;
-        }
-    }
-    return hits;
-}
-
-void Weapon::Draw() const
-{
-    const Rectangle rec = { anchor.x, anchor.y - thickness * 0.5f + 3, length, thickness };
+    const Vector2 at = { anchor.x + offset.x, anchor.y + offset.y };
+    const Rectangle rec = { at.x, at.y - thickness * 0.5f + 3, length, thickness };
     const Vector2 origin = { 0.0f, thickness * 0.5f };
 
-    DrawRectanglePro(rec, origin, rotationDegrees, BLACK);
-    DrawCircleV(anchor, thickness * 0.6f, BLACK);
-
-    for (const auto &b : bullets)
-    {
-        b.Draw();
-    }
+    batch.AddRectPro(rec, origin, rotationDegrees, BLACK);
+    batch.AddCircle(at, thickness * 0.6f, BLACK);
 }
 
     [[nodiscard]] bool Weapon::IsCooling() const
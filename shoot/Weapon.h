@@ -1,21 +1,21 @@
 #pragma once
 #include "raylib.h"
-#include <vector>
+#include <cstdint>
 
-struct EnvItem;
-
-#include "Bullet.h"
+class ProjectileSystem;
+class ShapeBatch;
 
 class Weapon
 {
 public:
     explicit Weapon(float length = 50.0f, float thickness = 6.0f, float bulletSpeed = 1800.0f, float cooldown = 1.0f);
 
+    void SetOwner(std::uint32_t ownerId, std::uint8_t team, int damage);
+
     void Update(float delta, const Vector2 &anchorPos, const Vector2 &targetPos,
-        const std::vector<EnvItem> &envItems, std::vector<Particle> &outParticles,
-        float spreadRadius = 0.0f, bool forceFire = false);
-    int CheckHit(Rectangle target, std::vector<Particle> &outParticles);
-    void Draw() const;
+        ProjectileSystem &projectiles, float spreadRadius = 0.0f, bool fire = false,
+        std::uint16_t rewindTicks = 0);
+    void Draw(ShapeBatch &batch, Vector2 offset = { 0.0f, 0.0f }) const;
 
     [[nodiscard]] bool IsCooling() const;
 
@@ -29,5 +29,7 @@ private:
     float cooldownTimer;
     float bulletSpeed;
 
-    std::vector<Bullet> bullets;
+    std::uint32_t ownerId = 0;
+    std::uint8_t team = 0;
+    int damage = 10;
 };
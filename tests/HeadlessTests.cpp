@@ -0,0 +1,22 @@
+#include "Test.h"
+
+#include "Game.h"
+
+#include <cmath>
+
+// Where the scripted player is after `seconds` of game time at `tickRate`.
+static Vector2 ScriptedPosition(const float tickRate, const float seconds)
+{
+    Game game(800, 600, true);
+    game.SetTickRate(tickRate);
+    game.Simulate(static_cast<int>(std::lround(seconds * tickRate)));
+    return game.GetWorld().Players().front().position;
+}
+
+TEST(ScriptPlaysInGameTime)
+{
+    const Vector2 at60 = ScriptedPosition(60.0f, 4.0f);
+    const Vector2 at120 = ScriptedPosition(120.0f, 4.0f);
+    CHECK(std::fabs(at60.x - at120.x) < 2.0f);
+    CHECK(std::fabs(at60.y - at120.y) < 2.0f);
+}
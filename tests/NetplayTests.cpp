@@ -0,0 +1,127 @@
+#include "Test.h"
+
+#include "Game.h"
+#include "GameServer.h"
+#include "Input.h"
+#include "NetworkClient.h"
+#include "OutgoingQueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Steps `game` in real time until `done` holds or `seconds` have passed.
+template <typename Done>
+static bool RunUntil(Game& game, const float seconds, Done done)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<float>(seconds);
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        game.Update(1.0f / 60.0f);
+        if (done())
+        {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    }
+    return false;
+}
+
+TEST(ClientFollowsServerTickRate)
+{
+    GameServer server(1234, 30.0f);
+    CHECK(server.Start());
+
+    Game game(800, 600);
+    game.SetTickRate(60.0f);
+    CHECK(RunUntil(game, 5.0f, [&game] { return !game.GetWorld().IsAuthoritative(); }));
+    CHECK(std::fabs(game.TickRate() - 30.0f) < 0.01f);
+
+    server.Stop();
+}
+
+// A crowd of scripted players in one room is more than a client's snapshot
+// budget can carry each time; every snapshot must still fit in it.
+TEST(SnapshotsStayWithinClientBudget)
+{
+    constexpr std::uint16_t PORT = 1235;
+    constexpr std::size_t CLIENTS = 96;
+    constexpr float TICK_RATE = 60.0f;
+    const std::size_t budget = std::min(
+        static_cast<std::size_t>(static_cast<float>(MatchRoom::CLIENT_BANDWIDTH * MatchRoom::SNAPSHOT_INTERVAL_TICKS) /
+                                 TICK_RATE),
+        OutgoingQueue::MAX_DATAGRAM_SIZE);
+
+    GameServer server(PORT, TICK_RATE);
+    CHECK(server.Start());
+
+    struct Client
+    {
+        NetworkClient net;
+        ScriptedInputSource input;
+        SnapshotHistory snapshots;
+        std::uint32_t latest = 0;
+        bool welcomed = false;
+    };
+    std::vector<std::unique_ptr<Client>> clients;
+    for (std::size_t i = 0; i < CLIENTS; ++i)
+    {
+        auto& client = clients.emplace_back(std::make_unique<Client>());
+        client->input = ScriptedInputSource(static_cast<unsigned>(i + 1), TICK_RATE);
+        CHECK(client->net.connectTo("127.0.0.1", PORT));
+    }
+
+    std::size_t snapshots = 0;
+    std::size_t largest = 0;
+    Packet packet;
+    const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(4);
+    while (std::chrono::steady_clock::now() < end)
+    {
+        for (auto& client : clients)
+        {
+            client->net.poll([&](const std::uint8_t* data, const std::size_t size) {
+                packet.clear();
+                if (!decodePacket(data, size, packet, &client->snapshots))
+                {
+                    return;
+                }
+                client->welcomed = client->welcomed || !packet.welcomes.empty();
+                if (!packet.snapshots.empty())
+                {
+                    ++snapshots;
+                    largest = std::max(largest, size);
+                    CHECK(size <= budget);
+                    if (packet.snapshots.front().tick > client->latest)
+                    {
+                        client->latest = packet.snapshots.front().tick;
+                        client->snapshots.store(client->latest, packet.players, packet.bots);
+                    }
+                }
+            });
+
+            if (client->welcomed)
+            {
+                const InputCommand cmd = client->input.Sample();
+                Packet out;
+                out.inputs.push_back({ cmd.sequence, cmd.moveX, cmd.jump, cmd.fire, cmd.aim, cmd.spread, 0 });
+                if (client->latest != 0)
+                {
+                    out.acks.push_back({ client->latest });
+                }
+                client->net.send(encodePacket(out), Channel::State);
+                client->net.flush();
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    }
+
+    // Otherwise the budget was never put to the test.
+    CHECK(snapshots > 0);
+    CHECK(largest > budget * 3 / 4);
+
+    clients.clear();
+    server.Stop();
+}
@@ -0,0 +1,44 @@
+#include "Test.h"
+
+#include "Profiler.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+// Another thread laps its ring several times while frames are closed. Every
+// event lasts exactly 1 ns, so a torn one (start and end from different
+// writes) shows up as a zone far longer than the events recorded.
+TEST(ProfilerReadsRingWhileItWraps)
+{
+    static const char* const ZONE = "test/wrapping ring";
+    constexpr std::uint64_t EVENTS = Profiler::RING_CAPACITY * 8;
+
+    Profiler& profiler = Profiler::Get();
+    std::atomic<bool> done{ false };
+    std::thread writer([&] {
+        for (std::uint64_t i = 0; i < EVENTS; ++i)
+        {
+            profiler.Record(ZONE, 2 * i, 2 * i + 1, 0);
+        }
+        done = true;
+    });
+
+    while (!done)
+    {
+        profiler.EndFrame();
+    }
+    writer.join();
+    profiler.EndFrame();
+
+    bool found = false;
+    for (const Profiler::ZoneStats& zone : profiler.Stats())
+    {
+        if (std::strcmp(zone.name, ZONE) == 0)
+        {
+            found = true;
+            CHECK(zone.maxMs <= static_cast<double>(EVENTS) * 1e-6);
+        }
+    }
+    CHECK(found);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+
+// Just enough of a test harness for the game's own checks: TEST defines a
+// function that registers itself, CHECK records a failure and carries on.
+struct TestCase
+{
+    const char* name;
+    void (*run)();
+};
+
+std::vector<TestCase>& TestRegistry();
+void TestFailed(const char* file, int line, const char* expression);
+
+#define TEST(name)                                                                        \
+    static void name();                                                                   \
+    static const bool name##Registered = (TestRegistry().push_back({ #name, name }), true); \
+    static void name()
+
+#define CHECK(condition)                                  \
+    do                                                    \
+    {                                                     \
+        if (!(condition))                                 \
+        {                                                 \
+            TestFailed(__FILE__, __LINE__, #condition);   \
+        }                                                 \
+    } while (false)
@@ -0,0 +1,50 @@
+#include "Test.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cstring>
+
+static int failures = 0;
+
+std::vector<TestCase>& TestRegistry()
+{
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+void TestFailed(const char* file, const int line, const char* expression)
+{
+    Log::Get().Flush();
+    std::printf("%s:%d: CHECK(%s) failed\n", file, line, expression);
+    ++failures;
+}
+
+// Runs every test, or only the ones named on the command line.
+int main(const int argc, char** argv)
+{
+    Log::SetLevel(LogLevel::Warn);
+
+    int run = 0;
+    for (const TestCase& test : TestRegistry())
+    {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i)
+        {
+            selected = selected || std::strcmp(argv[i], test.name) == 0;
+        }
+        if (!selected)
+        {
+            continue;
+        }
+
+        const int before = failures;
+        std::printf("[ RUN  ] %s\n", test.name);
+        test.run();
+        Log::Get().Flush();
+        std::printf("[ %s ] %s\n", failures == before ? " OK " : "FAIL", test.name);
+        ++run;
+    }
+
+    std::printf("%d test(s), %d failure(s)\n", run, failures);
+    return failures == 0 && run > 0 ? 0 : 1;
+}